@@ -0,0 +1,116 @@
+#ifndef HWD_BINDING_INDEX_H
+#define HWD_BINDING_INDEX_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Hash index over the key bindings in a mode.
+ *
+ * Entries are keyed on their modifiers, release flag and sorted key set, so
+ * that finding the bindings that could be triggered by a key press doesn't
+ * depend on how many bindings there are in total.  Input device identifiers
+ * are interned so that they can be compared as integers.
+ *
+ * Nothing in here may depend on wlroots or on the config structures, which
+ * lets the index be benchmarked in isolation.
+ */
+
+// Interned identifier that is used for bindings that apply to every device.
+#define HWD_BINDING_INDEX_INPUT_ANY 0
+
+struct hwd_binding_index_entry {
+    uint32_t modifiers;
+    bool release;
+    int input;
+
+    // Offset and length of the entry's keys in the index's key pool.
+    int keys_offset;
+    int keys_length;
+
+    // Position of the next entry with the same modifiers, release flag and
+    // keys, or -1.
+    int next;
+
+    void *data;
+};
+
+struct hwd_binding_index_slot {
+    uint32_t hash;
+
+    // Positions of the first and last entries in the chain, or -1 if the
+    // slot is empty.
+    int head;
+    int tail;
+};
+
+struct hwd_binding_index {
+    struct hwd_binding_index_entry *entries;
+    int entries_length;
+    int entries_capacity;
+
+    uint32_t *keys;
+    int keys_length;
+    int keys_capacity;
+
+    struct hwd_binding_index_slot *slots;
+    int slots_capacity; // Always a power of two.
+    int slots_used;
+
+    char **inputs;
+    int inputs_length;
+    int inputs_capacity;
+
+    // Positions of the entries found by the last call to
+    // `hwd_binding_index_match`.
+    int *matches;
+};
+
+struct hwd_binding_index *
+hwd_binding_index_create(void);
+
+void
+hwd_binding_index_destroy(struct hwd_binding_index *index);
+
+/**
+ * Returns the interned identifier for an input device identifier, or -1 if no
+ * entry refers to it.
+ */
+int
+hwd_binding_index_find_input(const struct hwd_binding_index *index, const char *input);
+
+/**
+ * Returns the interned identifier for an input device identifier, adding it to
+ * the index if it hasn't been seen before.  "*" always interns to
+ * `HWD_BINDING_INDEX_INPUT_ANY`.
+ */
+int
+hwd_binding_index_intern_input(struct hwd_binding_index *index, const char *input);
+
+/**
+ * Adds an entry to the index.  `keys` must be sorted in ascending order.
+ * Entries are returned by `hwd_binding_index_match` in the order in which they
+ * were added.
+ */
+void
+hwd_binding_index_add(
+    struct hwd_binding_index *index, uint32_t modifiers, bool release, const uint32_t *keys,
+    int keys_length, int input, void *data
+);
+
+/**
+ * Finds every entry with matching modifiers and release flag that has exactly
+ * the keys in `pressed`, or, unless exactly one key is pressed, that has
+ * `current` as its only key.  Positions of matching entries are written to
+ * `index->matches` in the order in which they were added, and the number of
+ * matches is returned.  Matches remain valid until the index is next modified
+ * or queried.
+ */
+int
+hwd_binding_index_match(
+    struct hwd_binding_index *index, uint32_t modifiers, bool release, const uint32_t *pressed,
+    int pressed_length, uint32_t current
+);
+
+#endif
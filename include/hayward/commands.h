@@ -1,6 +1,7 @@
 #ifndef HWD_COMMANDS_H
 #define HWD_COMMANDS_H
 
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
@@ -59,6 +60,67 @@ find_handler(char *line, const struct cmd_handler *cmd_handlers, size_t handlers
  */
 list_t *
 execute_command(char *command, struct hwd_seat *seat, struct hwd_window *container);
+
+struct cmd_compiled_step {
+    // NULL if no handler could be found for the command, in which case
+    // executing it fails in the same way as `execute_command`.
+    const struct cmd_handler *handler;
+
+    // The command as written, for logging.
+    char *text;
+
+    // Arguments after stripping quotes and replacing variables.  The array
+    // and the strings are packed into a single allocation of `argv_size`
+    // bytes so that they can be copied cheaply.
+    int argc;
+    char **argv;
+    size_t argv_size;
+};
+
+/**
+ * A command string that has been split, tokenised and resolved to handlers
+ * ahead of time, so that it can be run repeatedly without parsing.
+ */
+struct cmd_compiled {
+    int refcount;
+
+    // Value of `config->symbols_generation` when the command was compiled.
+    uint64_t symbols_generation;
+
+    char *source;
+
+    // Set if the command can't be compiled because it changes how later
+    // commands are parsed.  Dynamic commands are parsed each time they run.
+    bool dynamic;
+
+    struct cmd_compiled_step *steps;
+    int length;
+};
+
+/**
+ * Parses a command string, as it would be parsed by `execute_command`, and
+ * returns a compiled command with a single reference.
+ */
+struct cmd_compiled *
+cmd_compiled_new(const char *source);
+struct cmd_compiled *
+cmd_compiled_ref(struct cmd_compiled *compiled);
+void
+cmd_compiled_unref(struct cmd_compiled *compiled);
+/**
+ * Returns true if variables have changed since the command was compiled, and
+ * so it needs to be compiled again.
+ */
+bool
+cmd_compiled_is_stale(const struct cmd_compiled *compiled);
+/**
+ * Executes a compiled command.  Behaves in the same way as `execute_command`
+ * on the command's source.
+ */
+list_t *
+execute_compiled_command(
+    struct cmd_compiled *compiled, struct hwd_seat *seat, struct hwd_window *window
+);
 /**
  * Parse and handles a command during config file loading.
  *
@@ -96,6 +158,7 @@ window_resize_tiled(struct hwd_window *window, uint32_t axis, int amount);
 hwd_cmd cmd_exec_validate;
 hwd_cmd cmd_exec_process;
 
+hwd_cmd cmd_allow_tearing;
 hwd_cmd cmd_bindcode;
 hwd_cmd cmd_bindswitch;
 hwd_cmd cmd_bindsym;
@@ -126,6 +189,7 @@ hwd_cmd cmd_resize;
 hwd_cmd cmd_seat;
 hwd_cmd cmd_set;
 hwd_cmd cmd_tiling_drag_threshold;
+hwd_cmd cmd_title_update_interval;
 hwd_cmd cmd_unbindcode;
 hwd_cmd cmd_unbindswitch;
 hwd_cmd cmd_unbindsym;
@@ -170,6 +234,7 @@ hwd_cmd seat_cmd_hide_cursor;
 hwd_cmd seat_cmd_idle_inhibit;
 hwd_cmd seat_cmd_idle_wake;
 hwd_cmd seat_cmd_keyboard_grouping;
+hwd_cmd seat_cmd_pointer_coalesce;
 hwd_cmd seat_cmd_pointer_constraint;
 hwd_cmd seat_cmd_xcursor_theme;
 
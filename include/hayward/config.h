@@ -19,17 +19,12 @@
 
 // TODO: Refactor this shit
 
+struct cmd_compiled;
+struct hwd_binding_index;
+struct hwd_variables;
 struct hwd_window;
 struct hwd_column;
 
-/**
- * Describes a variable created via the `set` command.
- */
-struct hwd_variable {
-    char *name;
-    char *value;
-};
-
 enum binding_input_type {
     BINDING_KEYCODE,
     BINDING_KEYSYM,
@@ -63,6 +58,10 @@ struct hwd_binding {
     uint32_t modifiers;
     xkb_layout_index_t group;
     char *command;
+
+    // Pre-parsed form of `command`.  Compiled the first time the binding is
+    // triggered.
+    struct cmd_compiled *compiled;
 };
 
 enum hwd_switch_trigger {
@@ -101,6 +100,11 @@ struct hwd_mode {
     list_t *mouse_bindings;
     list_t *switch_bindings;
     bool pango;
+
+    // Indexes over `keysym_bindings` and `keycode_bindings`.  Built the first
+    // time they are needed, and reset to NULL whenever the bindings change.
+    struct hwd_binding_index *keysym_index;
+    struct hwd_binding_index *keycode_index;
 };
 
 struct input_config_mapped_from_region {
@@ -189,6 +193,12 @@ enum seat_config_hide_cursor_when_typing {
     HIDE_WHEN_TYPING_DISABLE,
 };
 
+enum seat_config_pointer_coalesce {
+    POINTER_COALESCE_DEFAULT, // the default is currently disabled
+    POINTER_COALESCE_ENABLE,
+    POINTER_COALESCE_DISABLE,
+};
+
 enum seat_config_allow_constrain {
     CONSTRAIN_DEFAULT, // the default is currently enabled
     CONSTRAIN_ENABLE,
@@ -220,6 +230,7 @@ struct seat_config {
     int hide_cursor_timeout;
     enum seat_config_hide_cursor_when_typing hide_cursor_when_typing;
     enum seat_config_allow_constrain allow_constrain;
+    enum seat_config_pointer_coalesce pointer_coalesce;
     enum seat_keyboard_grouping keyboard_grouping;
     uint32_t idle_inhibit_sources, idle_wake_sources;
     struct {
@@ -253,7 +264,10 @@ enum xwayland_mode {
 struct hwd_config {
     char *haywardnag_command;
     struct haywardnag_instance haywardnag_config_errors;
-    list_t *symbols;
+    struct hwd_variables *symbols;
+    // Incremented whenever a variable is set, so that compiled binding
+    // commands know when to replace variables again.
+    uint64_t symbols_generation;
     list_t *modes;
     list_t *cmd_queue;
     list_t *output_configs;
@@ -285,6 +299,10 @@ struct hwd_config {
 
     int tiling_drag_threshold;
 
+    // Minimum time, in milliseconds, between a window's title being updated
+    // on screen.  Zero to apply every change as it arrives.
+    int title_update_interval;
+
     list_t *config_chain;
     bool user_config_path;
     const char *current_config_path;
@@ -302,6 +320,9 @@ struct hwd_config {
 
     // The keysym to keycode translation
     struct xkb_state *keysym_translation_state;
+    // The entry in `input_configs` that `keysym_translation_state` was created
+    // from, or NULL if it uses the default keymap.
+    struct input_config *keysym_translation_config;
 
     // Context for command handlers
     struct {
@@ -356,9 +377,6 @@ config_add_haywardnag_warning(char *fmt, ...);
 void
 free_config(struct hwd_config *config);
 
-void
-free_hwd_variable(struct hwd_variable *var);
-
 /**
  * Does variable replacement for a string based on the config's currently loaded
  * variables.
@@ -381,6 +399,14 @@ input_config_fill_rule_names(struct input_config *ic, struct xkb_rule_names *rul
 void
 free_input_config(struct input_config *ic);
 
+/**
+ * Returns true if applying either config to a device would have the same
+ * effect.  Configs that load an xkb file are never equal, as the file may have
+ * changed since it was last read.
+ */
+bool
+input_config_equal(const struct input_config *a, const struct input_config *b);
+
 int
 seat_name_cmp(const void *item, const void *data);
 
@@ -390,6 +416,12 @@ new_seat_config(const char *name);
 void
 free_seat_config(struct seat_config *ic);
 
+/**
+ * Returns true if applying either config to a seat would have the same effect.
+ */
+bool
+seat_config_equal(const struct seat_config *a, const struct seat_config *b);
+
 struct seat_attachment_config *
 seat_attachment_config_new(void);
 
@@ -405,6 +437,13 @@ free_hwd_binding(struct hwd_binding *sb);
 void
 free_switch_binding(struct hwd_switch_binding *binding);
 
+/**
+ * Discards the indexes over a mode's key bindings.  Must be called whenever
+ * the mode's key bindings are changed.
+ */
+void
+mode_invalidate_binding_indexes(struct hwd_mode *mode);
+
 void
 seat_execute_command(struct hwd_seat *seat, struct hwd_binding *binding);
 
@@ -425,9 +464,21 @@ config_update_font_height(void);
 bool
 translate_binding(struct hwd_binding *binding);
 
+/**
+ * Re-translates the bindings in every mode using the keymap from
+ * `input_config`, or the default keymap if it is NULL.
+ */
 void
 translate_keysyms(struct input_config *input_config);
 
+/**
+ * Translates the bindings of a config that has just replaced `old_config`
+ * using the keymap from `input_config`.  Modes whose key bindings have not
+ * changed keep the bindings and binding indexes from `old_config`.
+ */
+void
+translate_reloaded_keysyms(struct hwd_config *old_config, struct input_config *input_config);
+
 void
 binding_add_translated(struct hwd_binding *binding, list_t *bindings);
 
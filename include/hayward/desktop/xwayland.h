@@ -14,6 +14,7 @@
 #include <wlr/util/box.h>
 #include <wlr/xwayland/xwayland.h>
 
+#include <hayward/input/cursor_theme.h>
 #include <hayward/tree/view.h>
 #include <hayward/tree/window.h>
 
@@ -36,7 +37,7 @@ enum atom_name {
 
 struct hwd_xwayland {
     struct wlr_xwayland *xwayland;
-    struct wlr_xcursor_manager *xcursor_manager;
+    struct hwd_cursor_theme *xcursor_theme;
 
     xcb_atom_t atoms[ATOM_LAST];
 
@@ -17,9 +17,10 @@
 #include <wlr/types/wlr_input_device.h>
 #include <wlr/types/wlr_pointer_constraints_v1.h>
 #include <wlr/types/wlr_pointer_gestures_v1.h>
-#include <wlr/types/wlr_xcursor_manager.h>
+#include <wlr/util/box.h>
 
 #include <hayward/config.h>
+#include <hayward/input/cursor_theme.h>
 #include <hayward/input/seat.h>
 #include <hayward/tree/output.h>
 
@@ -30,10 +31,32 @@
 #define HWD_SCROLL_LEFT KEY_MAX + 3
 #define HWD_SCROLL_RIGHT KEY_MAX + 4
 
+struct hwd_window;
+
+// The last surface found by `seat_get_target_at`, and the region around it in
+// which it is known to be the topmost surface.
+struct hwd_cursor_target_cache {
+    bool valid;
+    uint64_t scene_generation;
+
+    // Layout coordinates.  `box` excludes any part of the surface that is
+    // covered by other scene nodes.  The surface origin is subtracted from the
+    // cursor position to get surface local coordinates.
+    struct wlr_box box;
+    double surface_x, surface_y;
+
+    struct hwd_output *output;
+    struct hwd_window *window;
+    struct wlr_surface *surface;
+
+    struct wl_listener surface_commit;
+    struct wl_listener surface_destroy;
+};
+
 struct hwd_cursor {
     struct hwd_seat *seat;
     struct wlr_cursor *cursor;
-    struct wlr_xcursor_manager *xcursor_manager;
+    struct hwd_cursor_theme *xcursor_theme;
     struct wl_list tablets;
     struct wl_list tablet_pads;
 
@@ -84,6 +107,8 @@ struct hwd_cursor {
 
     struct wl_listener root_scene_changed;
 
+    struct hwd_cursor_target_cache target_cache;
+
     struct wl_event_source *hide_source;
     bool hidden;
     // This field is just a cache of the field in seat_config in order to avoid
@@ -91,11 +116,24 @@ struct hwd_cursor {
     // indicates that there is no cached value.
     enum seat_config_hide_cursor_when_typing hide_when_typing;
 
+    // Cache of the field in seat_config.  POINTER_COALESCE_DEFAULT indicates
+    // that there is no cached value.
+    enum seat_config_pointer_coalesce pointer_coalesce;
+
+    // If pointer motion is being coalesced, set when the cursor has moved but
+    // the seatop has not yet been told.  Flushed by `motion_timer` once per
+    // output refresh, or before any other seatop event.
+    bool motion_pending;
+    uint32_t motion_pending_time_msec;
+    // Time of the first motion event since the last flush, which is where
+    // the latency of the coalesced motion is measured from.
+    uint32_t motion_pending_start_msec;
+    struct wl_event_source *motion_timer;
+
     size_t pressed_button_count;
 };
 
 struct hwd_workspace;
-struct hwd_window;
 
 void
 seat_get_target_at(
@@ -112,6 +150,13 @@ cursor_notify_key_press(struct hwd_cursor *cursor);
 void
 cursor_handle_activity_from_device(struct hwd_cursor *cursor, struct wlr_input_device *device);
 
+/**
+ * Passes any pointer motion that is being held back by coalescing on to the
+ * seatop.
+ */
+void
+hwd_cursor_flush_motion(struct hwd_cursor *cursor);
+
 void
 cursor_set_image(struct hwd_cursor *cursor, const char *image, struct wl_client *client);
 
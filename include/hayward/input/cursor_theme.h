@@ -0,0 +1,59 @@
+#ifndef HWD_INPUT_CURSOR_THEME_H
+#define HWD_INPUT_CURSOR_THEME_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_xcursor_manager.h>
+
+/**
+ * Process-wide cache of xcursor themes.
+ *
+ * Seats and Xwayland that use the same theme and size share a single
+ * `wlr_xcursor_manager`, which holds the theme loaded at each scale.  Themes
+ * that are no longer used are kept around for a while, so that reloading the
+ * config or re-plugging a pointer doesn't have to read the theme from disk
+ * again.
+ */
+
+struct hwd_cursor_theme {
+    char *name; // NULL for the default theme.
+    uint32_t size;
+
+    int refcount;
+    struct wlr_xcursor_manager *manager;
+
+    // Scales that are waiting to be loaded in the background.
+    float *pending_scales;
+    int pending_scales_length;
+
+    struct wl_list link; // Cache, most recently used first.
+};
+
+/**
+ * Returns a reference to the theme with the given name and size, creating it
+ * if it isn't already cached.
+ */
+struct hwd_cursor_theme *
+cursor_theme_get(const char *name, uint32_t size);
+
+void
+cursor_theme_unref(struct hwd_cursor_theme *theme);
+
+/**
+ * Loads the theme at a scale, if it hasn't been loaded already.
+ */
+bool
+cursor_theme_load(struct hwd_cursor_theme *theme, float scale);
+
+/**
+ * Loads the theme at a scale from a later iteration of the event loop, so that
+ * reading the theme from disk doesn't hold up the current one.  The cursors
+ * that hayward sets itself are looked up at the same time.
+ */
+void
+cursor_theme_queue_load(struct hwd_cursor_theme *theme, float scale);
+
+#endif
@@ -2,11 +2,13 @@
 #define HWD_INPUT_INPUT_MANAGER_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <wayland-server-core.h>
 #include <wayland-util.h>
 
 #include <wlr/backend.h>
+#include <wlr/types/wlr_cursor_shape_v1.h>
 #include <wlr/types/wlr_input_device.h>
 #include <wlr/types/wlr_keyboard_shortcuts_inhibit_v1.h>
 #include <wlr/types/wlr_virtual_keyboard_v1.h>
@@ -21,6 +23,10 @@ struct hwd_input_device {
     struct wl_list link;
     struct wl_listener device_destroy;
     bool is_virtual;
+
+    // Link in hwd_input_manager::pending_devices while the device is waiting
+    // to be attached to seats.
+    struct wl_list pending_link;
 };
 
 struct hwd_input_manager {
@@ -30,11 +36,21 @@ struct hwd_input_manager {
     struct wlr_keyboard_shortcuts_inhibit_manager_v1 *keyboard_shortcuts_inhibit;
     struct wlr_virtual_keyboard_manager_v1 *virtual_keyboard;
     struct wlr_virtual_pointer_manager_v1 *virtual_pointer;
+    struct wlr_cursor_shape_manager_v1 *cursor_shape;
+
+    // Devices that have been plugged in since the last idle pass.  Docks and
+    // KVM switches attach many devices at once, so seats are only updated
+    // once for each burst.
+    struct wl_list pending_devices; // hwd_input_device::pending_link
+    struct wl_event_source *device_changes_idle;
+    int num_device_changes;
+    uint64_t device_changes_begin; // Latency clock, zero if disabled.
 
     struct wl_listener new_input;
     struct wl_listener keyboard_shortcuts_inhibit_new_inhibitor;
     struct wl_listener virtual_keyboard_new;
     struct wl_listener virtual_pointer_new;
+    struct wl_listener cursor_shape_request_set_shape;
 };
 
 /**
@@ -62,6 +78,13 @@ input_device_get_type(struct hwd_input_device *device);
 void
 input_manager_verify_fallback_seat(void);
 
+/**
+ * Schedules an idle pass that attaches newly plugged in devices to seats and
+ * then updates the capabilities and cursor themes of seats that changed.
+ */
+void
+input_manager_queue_device_changes(void);
+
 struct hwd_input_manager *
 input_manager_create(struct wl_display *wl_display, struct wlr_backend *backend);
 
@@ -71,8 +94,12 @@ input_manager_configure_all_inputs(void);
 void
 input_manager_apply_input_config(struct input_config *input_config);
 
+/**
+ * Applies the input and seat configs from a reloaded config.  Only devices and
+ * seats whose configuration differs from `old_config` are reconfigured.
+ */
 void
-input_manager_reset_all_inputs(void);
+input_manager_apply_reloaded_config(struct hwd_config *old_config);
 
 void
 input_manager_apply_seat_config(struct seat_config *seat_config);
@@ -100,6 +100,12 @@ struct hwd_seat {
 
     list_t *deferred_bindings; // struct hwd_binding
 
+    // Set when devices are added or removed.  The capabilities and cursor
+    // theme are only updated once the input manager has processed every
+    // device change in the current burst.
+    bool capabilities_dirty;
+    bool xcursor_dirty;
+
     struct hwd_input_method_relay im_relay;
 
     struct wl_listener request_start_drag;
@@ -162,6 +168,20 @@ seat_remove_device(struct hwd_seat *seat, struct hwd_input_device *device);
 void
 seat_configure_xcursor(struct hwd_seat *seat);
 
+/**
+ * Reloads the seat's cursor theme once the current burst of device changes
+ * has been processed.
+ */
+void
+seat_queue_configure_xcursor(struct hwd_seat *seat);
+
+/**
+ * Applies capability and cursor theme updates that were deferred while
+ * devices were being added and removed.
+ */
+void
+seat_flush_device_changes(struct hwd_seat *seat);
+
 // Force focus to a particular surface that is not part of the workspace
 // hierarchy (used for lockscreen)
 void
@@ -0,0 +1,148 @@
+#ifndef HWD_IPC_H
+#define HWD_IPC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <wayland-server-core.h>
+#include <wayland-util.h>
+
+#include <hayward/tree/transaction.h>
+
+struct hwd_snapshot;
+
+/**
+ * Unix socket that lets status bars and scripts run commands and be told
+ * about changes, without having to poll.  The path of the socket is exported
+ * to child processes as `HAYWARDSOCK`.
+ *
+ * Every message, in both directions, starts with a header made up of
+ * `HWD_IPC_MAGIC`, the length of the payload and the message type, both as
+ * 32 bit integers in native byte order.  Payloads are JSON, except for the
+ * payload of `HWD_IPC_COMMAND`, which is the command to run.  The reply to
+ * `HWD_IPC_GET_SNAPSHOT` carries the file descriptor of the layout snapshot,
+ * described in `hayward/snapshot.h`, as `SCM_RIGHTS` ancillary data.
+ *
+ * All of the commands in a single `HWD_IPC_COMMAND` message are applied in one
+ * transaction.  Changes made by several messages can be applied together by
+ * sending them between `HWD_IPC_BATCH_BEGIN` and `HWD_IPC_BATCH_END`.  Batches
+ * are ended automatically if the client disconnects or takes too long.
+ *
+ * Events are generated once a transaction has been applied, by comparing the
+ * state of each subscribed category with what was last sent.  Each event
+ * carries the whole state of its category, so a client that falls behind is
+ * only sent the latest state once it has caught up, rather than every change
+ * it missed.
+ */
+
+#define HWD_IPC_MAGIC "hwd-ipc"
+#define HWD_IPC_MAGIC_LENGTH 7
+#define HWD_IPC_HEADER_LENGTH (HWD_IPC_MAGIC_LENGTH + 2 * sizeof(uint32_t))
+
+// Request types, and the types of the replies to them.
+#define HWD_IPC_COMMAND 0
+#define HWD_IPC_GET_WORKSPACES 1
+#define HWD_IPC_SUBSCRIBE 2
+#define HWD_IPC_GET_OUTPUTS 3
+#define HWD_IPC_GET_WINDOWS 4
+#define HWD_IPC_GET_FOCUS 5
+#define HWD_IPC_GET_MODE 6
+#define HWD_IPC_GET_VERSION 7
+#define HWD_IPC_GET_SNAPSHOT 8
+#define HWD_IPC_BATCH_BEGIN 9
+#define HWD_IPC_BATCH_END 10
+
+// Event types have the high bit set.  The low bits index `hwd_ipc_event`.
+#define HWD_IPC_EVENT_FLAG 0x80000000u
+
+enum hwd_ipc_event {
+    HWD_IPC_EVENT_WORKSPACE,
+    HWD_IPC_EVENT_OUTPUT,
+    HWD_IPC_EVENT_MODE,
+    HWD_IPC_EVENT_WINDOW,
+    HWD_IPC_EVENT_FOCUS,
+
+    HWD_IPC_EVENT_COUNT,
+};
+
+struct hwd_ipc_client {
+    struct hwd_ipc_server *server;
+    struct wl_list link; // hwd_ipc_server::clients
+
+    int fd;
+    struct wl_event_source *event_source;
+
+    uint32_t subscriptions;  // Bitmask of `hwd_ipc_event`.
+    uint32_t pending_events; // Events waiting for the write buffer to drain.
+
+    // Number of transaction batches the client has open.
+    int batch_depth;
+    // Ends the client's batches if they are held for too long.  Only exists
+    // while `batch_depth` is non-zero.
+    struct wl_event_source *batch_timer;
+
+    // The message currently being read.
+    char header[HWD_IPC_HEADER_LENGTH];
+    size_t header_length;
+    uint32_t payload_type;
+    char *payload;
+    size_t payload_capacity;
+    size_t payload_length;
+    size_t payload_read;
+
+    char *write_buffer;
+    size_t write_capacity;
+    size_t write_length;
+    size_t write_offset;
+
+    // File descriptor to send with the byte at `send_fd_offset` of the write
+    // buffer, or -1.  Owned by the server.
+    int send_fd;
+    size_t send_fd_offset;
+};
+
+struct hwd_ipc_server {
+    char *socket_path;
+    int fd;
+    struct wl_event_loop *event_loop;
+    struct wl_event_source *event_source;
+
+    struct wl_list clients; // hwd_ipc_client::link
+
+    // Client whose messages are currently being handled.  Commands it runs can
+    // generate events, but it mustn't be destroyed underneath the read loop,
+    // so its events are flushed once the loop returns instead.
+    struct hwd_ipc_client *dispatching;
+
+    struct hwd_transaction_manager *transaction_manager;
+
+    // Created when a client first asks for it.
+    struct hwd_snapshot *snapshot;
+
+    // Payload of the last event of each type, used to tell whether anything
+    // changed.  NULL until a client subscribes to the event.
+    char *last_events[HWD_IPC_EVENT_COUNT];
+
+    struct wl_listener transaction_after_apply;
+};
+
+/**
+ * Opens the IPC socket and exports its path as `HAYWARDSOCK`.  Returns NULL
+ * if the socket can't be created.
+ */
+struct hwd_ipc_server *
+ipc_server_create(
+    struct wl_event_loop *event_loop, struct hwd_transaction_manager *transaction_manager
+);
+
+void
+ipc_server_destroy(struct hwd_ipc_server *server);
+
+/**
+ * Sends mode events to subscribers.  Mode changes don't go through a
+ * transaction, so have to be reported separately.
+ */
+void
+ipc_server_notify_mode(struct hwd_ipc_server *server);
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef HWD_LATENCY_H
+#define HWD_LATENCY_H
+
+#include <stdint.h>
+
+#include <wayland-server-core.h>
+
+/**
+ * Histograms of the time taken for input to reach clients, and for bindings
+ * and transactions to take effect.  Enabled with `-D latency`.  Histograms are
+ * written to the log, at info level, when hayward receives SIGUSR1 and when it
+ * shuts down.
+ *
+ * Spans begin at the timestamp of the libinput event, which is in
+ * milliseconds, so spans that start with an input event are only accurate to
+ * within a millisecond.
+ */
+
+enum latency_metric {
+    // Key event to `wlr_seat_keyboard_notify_key`.
+    LATENCY_KEY_TO_CLIENT,
+    // Key event to the end of the binding it triggered.
+    LATENCY_KEY_TO_BINDING,
+    // Key event to the transaction queued by its binding being applied.
+    LATENCY_KEY_TO_APPLY,
+    // Motion event to the seatop handling it.  Includes any delay added by
+    // motion coalescing.
+    LATENCY_POINTER_MOTION,
+    // Button event to the seatop handling it.
+    LATENCY_POINTER_BUTTON,
+    // Start of a transaction to the end of its commit phase.
+    LATENCY_TRANSACTION_COMMIT,
+    // End of the commit phase to every client confirming, or the timeout.
+    LATENCY_TRANSACTION_CONFIRM,
+    // Applying the transaction, including the after apply phase.
+    LATENCY_TRANSACTION_APPLY,
+    // First device being plugged in or removed to every seat being updated
+    // for the burst of changes it belongs to.
+    LATENCY_INPUT_HOTPLUG,
+
+    LATENCY_METRIC_COUNT,
+};
+
+// Buckets are log-linear: exact below 8us, then 8 buckets for every power of
+// two, which keeps the relative error under 12.5% over the whole range.
+#define LATENCY_HISTOGRAM_SUB_BUCKETS 8
+#define LATENCY_HISTOGRAM_BUCKETS ((64 - 2) * LATENCY_HISTOGRAM_SUB_BUCKETS)
+
+struct latency_histogram {
+    uint64_t count;
+    uint64_t sum_usec;
+    uint64_t max_usec;
+    uint64_t buckets[LATENCY_HISTOGRAM_BUCKETS];
+};
+
+void
+latency_init(struct wl_event_loop *event_loop);
+
+void
+latency_fini(void);
+
+/**
+ * Returns the current time in microseconds, or zero if latency tracking is
+ * disabled.
+ */
+uint64_t
+latency_now(void);
+
+/**
+ * Converts the millisecond timestamp of an input event to the clock used by
+ * `latency_now`.  Returns zero if latency tracking is disabled.
+ */
+uint64_t
+latency_event_time(uint32_t time_msec);
+
+/**
+ * Records the time elapsed since `begin_usec`.  Does nothing if `begin_usec`
+ * is zero, so that spans begun while tracking was disabled are ignored.
+ */
+void
+latency_record(enum latency_metric metric, uint64_t begin_usec);
+
+#endif
@@ -0,0 +1,155 @@
+#ifndef HWD_LAYOUT_H
+#define HWD_LAYOUT_H
+
+#include <stdbool.h>
+
+/**
+ * Pure geometry used when arranging the tree.
+ *
+ * Nothing in here may depend on wlroots or on the tree objects.  The tree is
+ * responsible for gathering inputs into these structures and for copying the
+ * results back out, which lets the layout calculations be timed and tested
+ * without a running compositor.
+ */
+
+struct hwd_layout_box {
+    double x, y;
+    double width, height;
+};
+
+struct hwd_layout_borders {
+    double titlebar_height;
+    double left;
+    double right;
+    double top;
+    double bottom;
+};
+
+// Minimum and maximum dimensions.  How zero or negative values are interpreted
+// depends on where the limits came from.
+struct hwd_layout_size_limits {
+    double min_width, max_width;
+    double min_height, max_height;
+};
+
+struct hwd_layout_tiling_column {
+    // The share of the output this column should occupy.  Zero or negative for
+    // columns that have just been added.  Normalized in place.
+    double width_fraction;
+
+    // Output.
+    struct hwd_layout_box box;
+};
+
+struct hwd_layout_column_child {
+    // Inputs.
+    double height_fraction;
+    double titlebar_height;
+    bool fullscreen;
+    bool active;
+
+    // Outputs.  `y_offset` is the unrounded distance from the top of the column
+    // to the top of the child, and is used to resume layout part way down a
+    // column.  Fullscreen children are skipped and only have `y_offset` set.
+    double y_offset;
+    double y;
+    double height;
+    bool shaded;
+};
+
+struct hwd_layout_column {
+    bool stacked;
+    struct hwd_layout_box box;
+
+    bool show_preview;
+    double preview_titlebar_height;
+    double preview_height_fraction;
+    double preview_baseline;
+    double preview_anchor_y;
+
+    // Totals calculated from the children by `hwd_layout_column_prepare`.
+    double visible_height_fraction;
+    double available_content_height;
+
+    // Outputs.  If the preview is shown, `preview_index` is the index of the
+    // child that the preview has been inserted before, or the number of
+    // children if it was inserted at the end.
+    int preview_index;
+    struct hwd_layout_box preview_box;
+};
+
+/**
+ * Divides an output's usable area between the columns on that output, leaving
+ * gaps of `gap` between them.  Any new columns are given the average width of
+ * the existing columns.  The last column takes up any remaining width.
+ */
+void
+hwd_layout_tiling(
+    const struct hwd_layout_box *area, double gap, struct hwd_layout_tiling_column *columns,
+    int count
+);
+
+/**
+ * Calculates the totals that the height of every non-fullscreen child of a
+ * column depends on.  Must be called before `hwd_layout_column`.
+ */
+void
+hwd_layout_column_prepare(
+    struct hwd_layout_column *column, const struct hwd_layout_column_child *children, int count
+);
+
+/**
+ * Given the parameters of the previous layout of a column, and the index of
+ * the first child whose inputs have changed since then, returns the index of
+ * the first child that needs to be laid out again.  Returns `count` if nothing
+ * would move.
+ */
+int
+hwd_layout_column_resume_index(
+    const struct hwd_layout_column *prev, int prev_count, const struct hwd_layout_column *next,
+    int count, int first_changed
+);
+
+/**
+ * Positions the children of a column, starting from child `first`.  Children
+ * before `first` must have been positioned by a previous call with the same
+ * parameters.
+ */
+void
+hwd_layout_column(
+    struct hwd_layout_column *column, struct hwd_layout_column_child *children, int count,
+    int first
+);
+
+/**
+ * Calculates the outer box of a floating window from the position of the
+ * center of its content, as a fraction of the output, and the size of its
+ * content.
+ */
+void
+hwd_layout_window_floating(
+    const struct hwd_layout_box *output, double center_x, double center_y, double content_width,
+    double content_height, const struct hwd_layout_borders *borders, struct hwd_layout_box *box
+);
+
+/**
+ * Calculates the box occupied by the content of a window, given its outer box.
+ */
+void
+hwd_layout_window_content(
+    const struct hwd_layout_box *box, const struct hwd_layout_borders *borders,
+    struct hwd_layout_box *content
+);
+
+/**
+ * Combines the configured limits on the size of floating windows with the
+ * limits requested by a window.  For configured limits, -1 means no limit and
+ * 0 means pick automatically.  For window limits 0 means no limit.
+ */
+void
+hwd_layout_floating_constraints(
+    const struct hwd_layout_size_limits *config, const struct hwd_layout_size_limits *window,
+    double layout_width, double layout_height, struct hwd_layout_size_limits *constraints
+);
+
+#endif
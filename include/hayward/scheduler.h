@@ -3,6 +3,7 @@
 
 #include <config.h>
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <time.h>
 
@@ -23,6 +24,10 @@ struct hwd_scene_output_scheduler {
     uint32_t refresh_nsec;
     int max_render_time; // In milliseconds
     struct wl_event_source *repaint_timer;
+
+    // Set for frames that should be committed with a tearing page flip, as
+    // decided by `hwd_tearing_should_tear`.
+    bool tearing;
 };
 
 struct hwd_scene_output_scheduler *
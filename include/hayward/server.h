@@ -14,11 +14,13 @@
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_drm_lease_v1.h>
+#include <wlr/types/wlr_ext_image_capture_source_v1.h>
 #include <wlr/types/wlr_idle_notify_v1.h>
 #include <wlr/types/wlr_input_method_v2.h>
 #include <wlr/types/wlr_linux_dmabuf_v1.h>
 #include <wlr/types/wlr_relative_pointer_v1.h>
 #include <wlr/types/wlr_session_lock_v1.h>
+#include <wlr/types/wlr_tearing_control_v1.h>
 #include <wlr/types/wlr_text_input_v3.h>
 
 #include <hayward/desktop/layer_shell.h>
@@ -39,6 +41,7 @@ struct hwd_server {
     struct wlr_allocator *allocator;
 
     struct wlr_compositor *compositor;
+    struct wl_listener new_surface;
 
     struct wlr_linux_dmabuf_v1 *linux_dmabuf_v1;
 
@@ -46,6 +49,8 @@ struct hwd_server {
 
     struct hwd_input_manager *input;
 
+    struct hwd_ipc_server *ipc;
+
     struct wl_listener new_output;
     struct wl_listener output_layout_change;
 
@@ -70,6 +75,9 @@ struct hwd_server {
     struct wlr_drm_lease_v1_manager *drm_lease_manager;
     struct wl_listener drm_lease_request;
 
+    struct wlr_ext_foreign_toplevel_image_capture_source_manager_v1 *window_capture_manager;
+    struct wl_listener window_capture_request;
+
     struct wlr_pointer_constraints_v1 *pointer_constraints;
     struct wl_listener pointer_constraint;
 
@@ -86,6 +94,8 @@ struct hwd_server {
         struct wl_listener manager_destroy;
     } session_lock;
 
+    struct wlr_tearing_control_manager_v1 *tearing_control;
+
     struct wlr_input_method_manager_v2 *input_method;
     struct wlr_text_input_manager_v3 *text_input;
 
@@ -98,9 +108,24 @@ struct hwd_server {
 
 extern struct hwd_server server;
 
+enum hwd_debug_validate {
+    HWD_DEBUG_VALIDATE_INCREMENTAL, // Check only objects touched by a transaction
+    HWD_DEBUG_VALIDATE_FULL,        // Check the whole tree on every transaction
+    HWD_DEBUG_VALIDATE_NONE,
+};
+
 struct hwd_debug {
     bool noatomic; // Ignore atomic layout updates
     bool txn_wait; // Always wait for the timeout before applying
+    bool latency;  // Collect input and transaction latency histograms
+
+    // How much of the tree to check for consistency before each transaction is
+    // committed.  Only has an effect in builds without NDEBUG.
+    enum hwd_debug_validate validate;
+
+    // In incremental mode, check the whole tree every `validate_sweep`
+    // transactions.  Zero to never check the whole tree.
+    int validate_sweep;
 };
 
 extern struct hwd_debug debug;
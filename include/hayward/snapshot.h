@@ -0,0 +1,123 @@
+#ifndef HWD_SNAPSHOT_H
+#define HWD_SNAPSHOT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <wayland-server-core.h>
+
+#include <hayward/tree/transaction.h>
+
+/**
+ * Read-only copy of the applied tree in shared memory, for clients that want
+ * the whole layout on every change without having it serialised for them.
+ * The file descriptor is handed out over the IPC socket.  It is opened
+ * read-only, but clients shouldn't rely on that to protect the contents.  The
+ * file is sealed against shrinking, so nothing a client does can invalidate
+ * the compositor's mapping.
+ *
+ * The file starts with a `hwd_snapshot_header`, followed by arrays of
+ * outputs, workspaces and windows, followed by a table of nul terminated
+ * strings.  Every offset is in bytes from the start of the file, except for
+ * string references, which are relative to `string_offset`.  Reference zero is
+ * always the empty string.
+ *
+ * The snapshot is rewritten in place after every transaction is applied, and
+ * guarded by a sequence lock.  Readers should:
+ *
+ * 1. Load `sequence` with acquire semantics and retry while it is odd.
+ * 2. If `size` is larger than their mapping, remap the file.
+ * 3. Copy out what they need.
+ * 4. Load `sequence` again and start over if it has changed.
+ *
+ * The file only ever grows, so a mapping is never invalidated.
+ */
+
+#define HWD_SNAPSHOT_MAGIC 0x73647768 // "hwds"
+#define HWD_SNAPSHOT_VERSION 1
+
+#define HWD_SNAPSHOT_OUTPUT_ENABLED (1u << 0)
+
+#define HWD_SNAPSHOT_WORKSPACE_ACTIVE (1u << 0)
+#define HWD_SNAPSHOT_WORKSPACE_FOCUSED (1u << 1)
+#define HWD_SNAPSHOT_WORKSPACE_URGENT (1u << 2)
+
+#define HWD_SNAPSHOT_WINDOW_FOCUSED (1u << 0)
+#define HWD_SNAPSHOT_WINDOW_FULLSCREEN (1u << 1)
+#define HWD_SNAPSHOT_WINDOW_FLOATING (1u << 2)
+#define HWD_SNAPSHOT_WINDOW_URGENT (1u << 3)
+
+struct hwd_snapshot_header {
+    uint32_t magic;
+    uint32_t version;
+
+    // Odd while the snapshot is being written.
+    _Atomic uint32_t sequence;
+
+    // Number of bytes of the file that are in use.
+    uint32_t size;
+
+    uint32_t output_count;
+    uint32_t output_offset;
+    uint32_t workspace_count;
+    uint32_t workspace_offset;
+    uint32_t window_count;
+    uint32_t window_offset;
+    uint32_t string_offset;
+    uint32_t string_length;
+
+    // Indices into the workspace and window arrays, or -1.
+    int32_t active_workspace;
+    int32_t focused_window;
+};
+
+struct hwd_snapshot_output {
+    uint64_t id;
+    uint32_t name;
+    uint32_t flags;
+    int32_t x, y;
+    int32_t width, height;
+    float scale;
+    uint32_t reserved;
+};
+
+struct hwd_snapshot_workspace {
+    uint64_t id;
+    uint32_t name;
+    uint32_t flags;
+};
+
+struct hwd_snapshot_window {
+    uint64_t id;
+    uint32_t title;
+    uint32_t flags;
+    int32_t x, y;
+    int32_t width, height;
+    uint32_t workspace; // Index into the workspace array.
+    uint32_t reserved;
+};
+
+struct hwd_snapshot {
+    int fd;
+    int read_only_fd;
+
+    void *data;
+    size_t capacity;
+
+    struct wl_listener transaction_after_apply;
+};
+
+struct hwd_snapshot *
+snapshot_create(struct hwd_transaction_manager *transaction_manager);
+
+void
+snapshot_destroy(struct hwd_snapshot *snapshot);
+
+/**
+ * Returns a read-only file descriptor for the snapshot.  The descriptor is
+ * owned by the snapshot and should not be closed.
+ */
+int
+snapshot_get_fd(struct hwd_snapshot *snapshot);
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef HWD_TEARING_H
+#define HWD_TEARING_H
+
+#include <stdbool.h>
+
+/**
+ * Decides whether an output should skip waiting for vblank and flip to new
+ * buffers as soon as they are ready.
+ *
+ * Like the layout code, nothing in here may depend on wlroots or on the tree
+ * objects.  The scheduler gathers the state of the output before each frame,
+ * which lets the policy be tested without a running compositor or hardware
+ * that is able to tear.
+ */
+
+struct hwd_tearing_state {
+    // Set if a fullscreen window is visible on the output.  The remaining
+    // window fields are ignored if not.
+    bool has_fullscreen_window;
+
+    // Set if the window has been opted in with the `allow_tearing` command.
+    bool window_allows_tearing;
+
+    // Set if the window's surface has asked for asynchronous presentation
+    // using `wp_tearing_control_v1`.
+    bool window_requests_async;
+
+    // Set while the session is locked, when the lock screen covers every
+    // output.
+    bool locked;
+};
+
+/**
+ * Returns true if the output should be committed immediately, with a tearing
+ * page flip, rather than being delayed to line up with the next refresh.
+ */
+bool
+hwd_tearing_should_tear(const struct hwd_tearing_state *state);
+
+#endif
@@ -9,6 +9,7 @@
 #include <wlr/types/wlr_scene.h>
 #include <wlr/util/box.h>
 
+#include <hayward/layout.h>
 #include <hayward/list.h>
 
 enum hwd_column_layout {
@@ -38,6 +39,21 @@ struct hwd_column_state {
     bool dead;
 };
 
+// Inputs to, and results of, the last layout of a column's children.  Used to
+// restart layout from the first child that could have moved, and to avoid
+// dirtying windows whose geometry is unchanged.
+struct hwd_column_arrange_cache {
+    bool valid;
+
+    struct hwd_layout_column params;
+
+    // Parallel arrays, with one entry for each window in `pending.children`.
+    struct hwd_window **windows;
+    struct hwd_layout_column_child *children;
+    int length;
+    int capacity;
+};
+
 struct hwd_column {
     size_t id;
 
@@ -48,6 +64,11 @@ struct hwd_column {
     bool dirty;
     bool dead;
 
+    // Set when a window in the column has been marked dirty.  Unless either
+    // this or `dirty` is set, arranging the column doesn't need to visit any
+    // of its windows.
+    bool dirty_children;
+
     list_t *children; // struct hwd_window
     struct hwd_window *active_child;
 
@@ -78,6 +99,8 @@ struct hwd_column {
     // Used for doing the resize calculations
     double child_total_width;
 
+    struct hwd_column_arrange_cache arrange_cache;
+
     struct wlr_scene_tree *scene_tree;
 
     struct {
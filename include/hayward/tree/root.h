@@ -4,11 +4,14 @@
 #include <config.h>
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <wayland-server-core.h>
 #include <wayland-util.h>
 
 #include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_ext_foreign_toplevel_list_v1.h>
+#include <wlr/types/wlr_foreign_toplevel_management_v1.h>
 #include <wlr/types/wlr_layer_shell_v1.h>
 #include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_scene.h>
@@ -71,12 +74,20 @@ struct hwd_root {
     struct hwd_output *active_output;
 
     struct hwd_workspace_manager_v1 *workspace_manager;
+    struct wlr_foreign_toplevel_manager_v1 *foreign_toplevel_manager;
+    struct wlr_ext_foreign_toplevel_list_v1 *ext_foreign_toplevel_list;
 
     // Previously applied theme that should be cleaned up after transaction
     // apply.
     struct hwd_theme *orphaned_theme;
 
     struct wlr_scene *root_scene;
+
+    // Incremented whenever the scene may have changed, either because a
+    // transaction was applied or because a client committed a surface.
+    // Used to invalidate anything derived from the scene graph.
+    uint64_t scene_generation;
+
     struct {
         struct wlr_scene_tree *background;
         struct wlr_scene_tree *workspaces;
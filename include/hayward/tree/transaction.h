@@ -5,6 +5,7 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include <wayland-server-core.h>
 
@@ -37,6 +38,7 @@ enum hwd_transaction_phase {
 };
 
 struct hwd_transaction_manager {
+    // Number of open batches.  No transaction is committed while non-zero.
     int depth;
     bool queued;
 
@@ -49,6 +51,15 @@ struct hwd_transaction_manager {
     hwd_timestamp begin_transaction;
     hwd_timestamp begin_waiting_confirm;
 
+    // Latency clock timestamps, zero if latency tracking is disabled.
+    uint64_t latency_begin_transaction;
+    uint64_t latency_begin_waiting_confirm;
+
+    // Earliest input event that the queued and the in-flight transactions
+    // are a response to, or zero.
+    uint64_t latency_queued_input;
+    uint64_t latency_committed_input;
+
     struct {
         struct wl_signal before_commit;
         struct wl_signal commit;
@@ -79,4 +90,25 @@ hwd_transaction_manager_acquire_commit_lock(struct hwd_transaction_manager *mana
 void
 hwd_transaction_manager_release_commit_lock(struct hwd_transaction_manager *manager);
 
+/**
+ * Holds back the queued transaction until the matching call to
+ * `hwd_transaction_manager_end_batch`, so that changes made in between are
+ * committed, configured and applied together.  Batches nest.  Transactions that
+ * are already in flight are not affected.
+ */
+void
+hwd_transaction_manager_begin_batch(struct hwd_transaction_manager *manager);
+
+void
+hwd_transaction_manager_end_batch(struct hwd_transaction_manager *manager);
+
+/**
+ * Attributes the queued transaction, if there is one, to an input event so
+ * that the time from the event to the transaction being applied is recorded.
+ */
+void
+hwd_transaction_manager_track_input(
+    struct hwd_transaction_manager *manager, uint64_t event_time_usec
+);
+
 #endif
@@ -6,8 +6,10 @@
 
 #include <wayland-server-core.h>
 
-#include <wlr/render/wlr_texture.h>
 #include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_ext_foreign_toplevel_list_v1.h>
+#include <wlr/types/wlr_ext_image_capture_source_v1.h>
+#include <wlr/types/wlr_foreign_toplevel_management_v1.h>
 #include <wlr/types/wlr_scene.h>
 #include <wlr/util/addon.h>
 #include <wlr/util/box.h>
@@ -25,6 +27,8 @@ struct hwd_output;
 struct hwd_workspace;
 struct hwd_view;
 
+// The flags come after the doubles and the theme pointer so that they don't
+// leave padding between them.
 struct hwd_window_state {
     // Origin of window in layout coordinates.
     double x, y;
@@ -32,18 +36,6 @@ struct hwd_window_state {
     // shaded then height should be set to the titlebar height.
     double width, height;
 
-    // Indicates if only the titlebar of the window should be rendered.  Golden
-    // source is layout and active child of parent column.  Updated in arrange.
-    bool shaded;
-    bool fullscreen;
-
-    // Cached reference to currently applicable window theme.
-    struct hwd_theme_window *theme;
-
-    // Cached flag indicating whether the window is focused.  Should only be
-    // updated by calling one of the `window_reconcile_` functions.
-    bool focused;
-
     // These are in layout coordinates.
     double titlebar_height;
     double border_left;
@@ -53,24 +45,45 @@ struct hwd_window_state {
     double content_x, content_y;
     double content_width, content_height;
 
+    // Cached reference to currently applicable window theme.
+    struct hwd_theme_window *theme;
+
+    // Indicates if only the titlebar of the window should be rendered.  Golden
+    // source is layout and active child of parent column.  Updated in arrange.
+    bool shaded;
+    bool fullscreen;
+
+    // Cached flag indicating whether the window is focused.  Should only be
+    // updated by calling one of the `window_reconcile_` functions.
+    bool focused;
+
     bool dead;
 };
 
 struct hwd_window {
-    size_t id;
+    // Fields read by the arrange, commit and hit-testing loops are grouped at
+    // the front.  Anything only needed when the window is created, destroyed
+    // or re-rendered belongs further down.
 
-    struct hwd_root *root;
+    bool dirty;
+    bool dead;
 
-    // Forward link to the view.  The window owns the view only if the view's
-    // window pointer also points back to the window.
-    struct hwd_view *view;
+    bool fullscreen;
 
-    struct hwd_window_state pending;
-    struct hwd_window_state committed;
-    struct hwd_window_state current;
+    // If true, the window has been plucked from the normal plane of existence
+    // and is being moved in sync with the mouse.
+    bool moving;
+    bool resizing;
 
-    bool dirty;
-    bool dead;
+    bool is_configuring;
+
+    bool is_urgent;
+
+    // Set by the `allow_tearing` command.  The window may only tear if it is
+    // fullscreen and its client also asks to.
+    bool allow_tearing;
+
+    struct hwd_window_state pending;
 
     // Cached backlink to workspace containing the floating window or  column
     // containing the child window.  Should only be updated by calling one of
@@ -84,21 +97,20 @@ struct hwd_window {
     // the window's history.
     struct hwd_column *column;
 
-    // A list of disabled outputs that this window has been evacuated from, in
-    // priority order from highest (earliest) to lowest (most recent).  If the
-    // pending output for a window is disabled, the window will be moved to a
-    // new output and the old output will be added to the end of this list.  If
-    // an output in this list is subsequently re-enabled then it will be set as
-    // the pending output and later entries in this list will be cleared.  If a
-    // window is moved manually then its history will be cleared.
-    //
-    // The goal is to make sure that windows always stay exactly where you put
-    // them, regardless of how many times outputs are unplugged or reconfigured.
-    list_t *output_history; // struct dtl_output *
     struct hwd_output *output;
 
-    // Optional parent window that this window is transient for.
-    struct hwd_window *parent;
+    struct hwd_root *root;
+
+    // Forward link to the view.  The window owns the view only if the view's
+    // window pointer also points back to the window.
+    struct hwd_view *view;
+
+    // The fraction of vertical space available for content that should be
+    // allocated to this window when the containing column has an un-pinned
+    // window focused and this window is pinned.  When floating, this is
+    // relative to the average height fraction prior to being extracted from a
+    // column.
+    double height_fraction;
 
     // This is the last manually assigned floating position of the window.  If a
     // floating window is made tiling or fullscreen, this will be preserved so
@@ -112,37 +124,55 @@ struct hwd_window {
     double floating_x, floating_y;
     double floating_width, floating_height;
 
+    struct hwd_window_state committed;
+    struct hwd_window_state current;
+
+    size_t id;
+
+    // A list of disabled outputs that this window has been evacuated from, in
+    // priority order from highest (earliest) to lowest (most recent).  If the
+    // pending output for a window is disabled, the window will be moved to a
+    // new output and the old output will be added to the end of this list.  If
+    // an output in this list is subsequently re-enabled then it will be set as
+    // the pending output and later entries in this list will be cleared.  If a
+    // window is moved manually then its history will be cleared.
+    //
+    // The goal is to make sure that windows always stay exactly where you put
+    // them, regardless of how many times outputs are unplugged or reconfigured.
+    list_t *output_history; // struct dtl_output *
+
+    // Optional parent window that this window is transient for.
+    struct hwd_window *parent;
+
     double natural_width, natural_height;
     double minimum_width, minimum_height;
     double maximum_width, maximum_height;
 
-    bool fullscreen;
+    char *title;
+    char *app_id;
 
-    // If true, the window has been plucked from the normal plane of existence
-    // and is being moved in sync with the mouse.
-    bool moving;
-    bool resizing;
+    // Title waiting for `title_timer` to fire.  Clients that change their
+    // title faster than `title_update_interval` only have the latest title
+    // applied when it does.
+    char *pending_title;
+    struct wl_event_source *title_timer;
 
-    bool is_configuring;
+    // Handle advertising the window to taskbars.  Updated, with only the
+    // fields that changed, when the window is committed.
+    struct wlr_foreign_toplevel_handle_v1 *foreign_toplevel;
 
-    char *title;
+    // The same, for ext-foreign-toplevel-list, which is what clients use to
+    // pick a window to capture.
+    struct wlr_ext_foreign_toplevel_handle_v1 *ext_foreign_toplevel;
 
-    // The fraction of vertical space available for content that should be
-    // allocated to this window when the containing column has an un-pinned
-    // window focused and this window is pinned.  When floating, this is
-    // relative to the average height fraction prior to being extracted from a
-    // column.
-    double height_fraction;
+    // A scene containing only the window's surfaces, so that captures aren't
+    // affected by anything on top of the window, and the capture source that
+    // renders it.  Created when a client first asks to capture the window.
+    struct wlr_scene *image_capture_scene;
+    struct wlr_ext_image_capture_source_v1 *image_capture_source;
 
-    bool is_urgent;
     struct wl_event_source *urgent_timer;
 
-    struct wlr_texture *title_focused;
-    struct wlr_texture *title_focused_inactive;
-    struct wlr_texture *title_focused_tab_title;
-    struct wlr_texture *title_unfocused;
-    struct wlr_texture *title_urgent;
-
     struct wlr_scene_tree *scene_tree;
     struct wlr_addon scene_tree_marker;
 
@@ -164,6 +194,9 @@ struct hwd_window {
     struct wl_listener transaction_commit;
     struct wl_listener transaction_apply;
     struct wl_listener transaction_after_apply;
+    struct wl_listener foreign_toplevel_request_activate;
+    struct wl_listener foreign_toplevel_request_close;
+    struct wl_listener foreign_toplevel_request_fullscreen;
 
     struct {
         struct wl_signal close;
@@ -236,6 +269,9 @@ window_end_mouse_operation(struct hwd_window *window);
 void
 window_set_title(struct hwd_window *window, const char *title);
 
+void
+window_set_app_id(struct hwd_window *window, const char *app_id);
+
 void
 window_set_natural_size(struct hwd_window *window, double width, double height);
 
@@ -328,4 +364,11 @@ window_get_next_sibling(struct hwd_window *window);
 struct hwd_window *
 window_for_scene_node(struct wlr_scene_node *node);
 
+/**
+ * Returns a source that can be used to capture the contents of the window,
+ * or NULL if the window has no surface to capture.
+ */
+struct wlr_ext_image_capture_source_v1 *
+window_get_image_capture_source(struct hwd_window *window);
+
 #endif
@@ -18,6 +18,7 @@ enum hwd_focus_mode {
     F_FLOATING,
 };
 
+struct hwd_layout_tiling_column;
 struct hwd_view;
 
 struct hwd_workspace_state {
@@ -54,6 +55,11 @@ struct hwd_workspace {
 
     enum hwd_focus_mode focus_mode;
 
+    // Scratch space reused by `workspace_arrange` to avoid allocating on every
+    // transaction.
+    struct hwd_layout_tiling_column *tiling_layout;
+    int tiling_layout_capacity;
+
     struct hwd_workspace_handle_v1 *workspace_handle;
 
     struct wlr_scene_tree *scene_tree;
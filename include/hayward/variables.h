@@ -0,0 +1,67 @@
+#ifndef HWD_VARIABLES_H
+#define HWD_VARIABLES_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Hash table of the variables defined with `set`, and the expansion of
+ * variables in commands.
+ *
+ * Variables are matched on the longest name that prefixes the text following
+ * a `$`.  Prefix hashes are computed incrementally, so finding the longest
+ * match costs at most one probe for each distinct name length, and doesn't
+ * depend on how many variables have been defined.
+ *
+ * Nothing in here may depend on wlroots or on the config structures, which
+ * lets the table be benchmarked in isolation.
+ */
+
+struct hwd_variables_slot {
+    // NULL if the slot is empty.
+    char *name;
+    size_t name_length;
+    uint32_t hash;
+
+    char *value;
+    size_t value_length;
+};
+
+struct hwd_variables {
+    struct hwd_variables_slot *slots;
+    int slots_capacity; // Always a power of two.
+    int length;
+
+    // Number of variables with each name length, used to skip lengths that
+    // can't match.  Indexed up to and including `max_name_length`.
+    int *name_lengths;
+    size_t max_name_length;
+
+    // Scratch space for the hashes of each prefix of the text being matched.
+    uint32_t *prefix_hashes;
+};
+
+struct hwd_variables *
+hwd_variables_create(void);
+
+void
+hwd_variables_destroy(struct hwd_variables *variables);
+
+/**
+ * Sets a variable, replacing its value if it is already defined.  Both strings
+ * are copied.
+ */
+void
+hwd_variables_set(struct hwd_variables *variables, const char *name, const char *value);
+
+/**
+ * Returns a newly allocated copy of `str` with every variable replaced by its
+ * value.
+ *
+ * A `$` preceded by a single backslash is left alone, and `$$` is replaced by
+ * a single `$`.  Substituted values are not themselves expanded.
+ */
+char *
+hwd_variables_expand(struct hwd_variables *variables, const char *str);
+
+#endif
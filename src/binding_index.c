@@ -0,0 +1,248 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/binding_index.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HWD_BINDING_INDEX_INITIAL_SLOTS 16
+
+static uint32_t
+hwd_binding_index_hash(uint32_t modifiers, bool release, const uint32_t *keys, int keys_length) {
+    // FNV-1a over 32 bit words, followed by the murmur3 finalizer to spread
+    // the bits of similar key sets across the table.
+    uint32_t hash = 2166136261u;
+    hash = (hash ^ modifiers) * 16777619u;
+    hash = (hash ^ (uint32_t)release) * 16777619u;
+    for (int i = 0; i < keys_length; i++) {
+        hash = (hash ^ keys[i]) * 16777619u;
+    }
+
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static struct hwd_binding_index_slot *
+hwd_binding_index_find_slot(
+    const struct hwd_binding_index *index, uint32_t hash, uint32_t modifiers, bool release,
+    const uint32_t *keys, int keys_length
+) {
+    uint32_t mask = index->slots_capacity - 1;
+
+    // The table is never more than half full, so this always terminates.
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        struct hwd_binding_index_slot *slot = &index->slots[i];
+        if (slot->head == -1) {
+            return slot;
+        }
+        if (slot->hash != hash) {
+            continue;
+        }
+
+        const struct hwd_binding_index_entry *entry = &index->entries[slot->head];
+        if (entry->modifiers == modifiers && entry->release == release &&
+            entry->keys_length == keys_length &&
+            memcmp(&index->keys[entry->keys_offset], keys, sizeof(uint32_t) * keys_length) == 0) {
+            return slot;
+        }
+    }
+}
+
+static void
+hwd_binding_index_grow_slots(struct hwd_binding_index *index) {
+    struct hwd_binding_index_slot *old_slots = index->slots;
+    int old_capacity = index->slots_capacity;
+
+    index->slots_capacity *= 2;
+    index->slots = malloc(sizeof(struct hwd_binding_index_slot) * index->slots_capacity);
+    assert(index->slots != NULL);
+    for (int i = 0; i < index->slots_capacity; i++) {
+        index->slots[i].head = -1;
+        index->slots[i].tail = -1;
+    }
+
+    // Every chain in the old table has a distinct key, so we only need to
+    // look for the first empty slot.
+    uint32_t mask = index->slots_capacity - 1;
+    for (int i = 0; i < old_capacity; i++) {
+        struct hwd_binding_index_slot *old_slot = &old_slots[i];
+        if (old_slot->head == -1) {
+            continue;
+        }
+
+        uint32_t j = old_slot->hash & mask;
+        while (index->slots[j].head != -1) {
+            j = (j + 1) & mask;
+        }
+        index->slots[j] = *old_slot;
+    }
+
+    free(old_slots);
+}
+
+struct hwd_binding_index *
+hwd_binding_index_create(void) {
+    struct hwd_binding_index *index = calloc(1, sizeof(struct hwd_binding_index));
+    assert(index != NULL);
+
+    index->slots_capacity = HWD_BINDING_INDEX_INITIAL_SLOTS;
+    index->slots = malloc(sizeof(struct hwd_binding_index_slot) * index->slots_capacity);
+    assert(index->slots != NULL);
+    for (int i = 0; i < index->slots_capacity; i++) {
+        index->slots[i].head = -1;
+        index->slots[i].tail = -1;
+    }
+
+    int any = hwd_binding_index_intern_input(index, "*");
+    assert(any == HWD_BINDING_INDEX_INPUT_ANY);
+
+    return index;
+}
+
+void
+hwd_binding_index_destroy(struct hwd_binding_index *index) {
+    if (index == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < index->inputs_length; i++) {
+        free(index->inputs[i]);
+    }
+    free(index->inputs);
+    free(index->slots);
+    free(index->keys);
+    free(index->matches);
+    free(index->entries);
+    free(index);
+}
+
+int
+hwd_binding_index_find_input(const struct hwd_binding_index *index, const char *input) {
+    // Configs only ever refer to a handful of devices.
+    for (int i = 0; i < index->inputs_length; i++) {
+        if (strcmp(index->inputs[i], input) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int
+hwd_binding_index_intern_input(struct hwd_binding_index *index, const char *input) {
+    int id = hwd_binding_index_find_input(index, input);
+    if (id != -1) {
+        return id;
+    }
+
+    if (index->inputs_length == index->inputs_capacity) {
+        index->inputs_capacity = index->inputs_capacity ? index->inputs_capacity * 2 : 4;
+        index->inputs = realloc(index->inputs, sizeof(char *) * index->inputs_capacity);
+        assert(index->inputs != NULL);
+    }
+
+    index->inputs[index->inputs_length] = strdup(input);
+    assert(index->inputs[index->inputs_length] != NULL);
+
+    return index->inputs_length++;
+}
+
+void
+hwd_binding_index_add(
+    struct hwd_binding_index *index, uint32_t modifiers, bool release, const uint32_t *keys,
+    int keys_length, int input, void *data
+) {
+    if (index->entries_length == index->entries_capacity) {
+        index->entries_capacity = index->entries_capacity ? index->entries_capacity * 2 : 16;
+        index->entries = realloc(
+            index->entries, sizeof(struct hwd_binding_index_entry) * index->entries_capacity
+        );
+        assert(index->entries != NULL);
+        index->matches = realloc(index->matches, sizeof(int) * index->entries_capacity);
+        assert(index->matches != NULL);
+    }
+
+    if (index->keys_length + keys_length > index->keys_capacity) {
+        while (index->keys_length + keys_length > index->keys_capacity) {
+            index->keys_capacity = index->keys_capacity ? index->keys_capacity * 2 : 32;
+        }
+        index->keys = realloc(index->keys, sizeof(uint32_t) * index->keys_capacity);
+        assert(index->keys != NULL);
+    }
+
+    int position = index->entries_length++;
+    struct hwd_binding_index_entry *entry = &index->entries[position];
+    entry->modifiers = modifiers;
+    entry->release = release;
+    entry->input = input;
+    entry->keys_offset = index->keys_length;
+    entry->keys_length = keys_length;
+    entry->next = -1;
+    entry->data = data;
+
+    if (keys_length > 0) {
+        memcpy(&index->keys[index->keys_length], keys, sizeof(uint32_t) * keys_length);
+        index->keys_length += keys_length;
+    }
+
+    uint32_t hash = hwd_binding_index_hash(modifiers, release, keys, keys_length);
+    struct hwd_binding_index_slot *slot =
+        hwd_binding_index_find_slot(index, hash, modifiers, release, keys, keys_length);
+    if (slot->head != -1) {
+        index->entries[slot->tail].next = position;
+        slot->tail = position;
+        return;
+    }
+
+    slot->hash = hash;
+    slot->head = position;
+    slot->tail = position;
+    index->slots_used++;
+
+    if (index->slots_used * 2 >= index->slots_capacity) {
+        hwd_binding_index_grow_slots(index);
+    }
+}
+
+int
+hwd_binding_index_match(
+    struct hwd_binding_index *index, uint32_t modifiers, bool release, const uint32_t *pressed,
+    int pressed_length, uint32_t current
+) {
+    uint32_t hash = hwd_binding_index_hash(modifiers, release, pressed, pressed_length);
+    int exact =
+        hwd_binding_index_find_slot(index, hash, modifiers, release, pressed, pressed_length)->head;
+
+    // If no multiple-key binding has matched, single-key bindings can still
+    // be triggered by the newly pressed key.  If only one key is pressed then
+    // these are the same as the exact matches.
+    int single = -1;
+    if (pressed_length != 1) {
+        hash = hwd_binding_index_hash(modifiers, release, &current, 1);
+        single = hwd_binding_index_find_slot(index, hash, modifiers, release, &current, 1)->head;
+    }
+
+    // Both chains are in ascending order, so merge them to preserve the order
+    // in which entries were added.
+    int count = 0;
+    while (exact != -1 || single != -1) {
+        if (single == -1 || (exact != -1 && exact < single)) {
+            index->matches[count++] = exact;
+            exact = index->entries[exact].next;
+        } else {
+            index->matches[count++] = single;
+            single = index->entries[single].next;
+        }
+    }
+
+    return count;
+}
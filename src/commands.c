@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <ctype.h>
 #include <stdarg.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -76,6 +77,7 @@ static const struct cmd_handler handlers[] = {
     {"seat", cmd_seat},
     {"set", cmd_set},
     {"tiling_drag_threshold", cmd_tiling_drag_threshold},
+    {"title_update_interval", cmd_title_update_interval},
     {"unbindcode", cmd_unbindcode},
     {"unbindswitch", cmd_unbindswitch},
     {"unbindsym", cmd_unbindsym},
@@ -91,13 +93,14 @@ static const struct cmd_handler config_handlers[] = {
 
 /* Runtime-only commands. Keep alphabetized */
 static const struct cmd_handler command_handlers[] = {
-    {"exit", cmd_exit},             //
-    {"floating", cmd_floating},     //
-    {"fullscreen", cmd_fullscreen}, //
-    {"kill", cmd_kill},             //
-    {"layout", cmd_layout},         //
-    {"move", cmd_move},             //
-    {"nop", cmd_nop},               //
+    {"allow_tearing", cmd_allow_tearing}, //
+    {"exit", cmd_exit},                   //
+    {"floating", cmd_floating},           //
+    {"fullscreen", cmd_fullscreen},       //
+    {"kill", cmd_kill},                   //
+    {"layout", cmd_layout},               //
+    {"move", cmd_move},                   //
+    {"nop", cmd_nop},                     //
     {"reload", cmd_reload},
     {"resize", cmd_resize}, //
 };
@@ -144,6 +147,38 @@ find_core_handler(char *line) {
     );
 }
 
+/**
+ * Splits a single command into arguments, strips quotes, looks up its handler
+ * and, if one is found, replaces variables in its arguments.  The arguments
+ * are returned even if no handler is found, and must be freed by the caller.
+ */
+static const struct cmd_handler *
+parse_command(char *cmd, int *argc_out, char ***argv_out) {
+    // TODO better handling of argv
+    int argc;
+    char **argv = split_args(cmd, &argc);
+    if (strcmp(argv[0], "exec") != 0 && strcmp(argv[0], "exec_always") != 0 &&
+        strcmp(argv[0], "mode") != 0) {
+        for (int i = 1; i < argc; ++i) {
+            if (*argv[i] == '\"' || *argv[i] == '\'') {
+                strip_quotes(argv[i]);
+            }
+        }
+    }
+    const struct cmd_handler *handler = find_core_handler(argv[0]);
+
+    // Var replacement, for all but first argument of set
+    if (handler) {
+        for (int i = handler->handle == cmd_set ? 2 : 1; i < argc; ++i) {
+            argv[i] = do_var_replacement(argv[i]);
+        }
+    }
+
+    *argc_out = argc;
+    *argv_out = argv;
+    return handler;
+}
+
 list_t *
 execute_command(char *_exec, struct hwd_seat *seat, struct hwd_window *window) {
     char *cmd;
@@ -179,18 +214,9 @@ execute_command(char *_exec, struct hwd_seat *seat, struct hwd_window *window) {
             continue;
         }
         wlr_log(WLR_INFO, "Handling command '%s'", cmd);
-        // TODO better handling of argv
         int argc;
-        char **argv = split_args(cmd, &argc);
-        if (strcmp(argv[0], "exec") != 0 && strcmp(argv[0], "exec_always") != 0 &&
-            strcmp(argv[0], "mode") != 0) {
-            for (int i = 1; i < argc; ++i) {
-                if (*argv[i] == '\"' || *argv[i] == '\'') {
-                    strip_quotes(argv[i]);
-                }
-            }
-        }
-        const struct cmd_handler *handler = find_core_handler(argv[0]);
+        char **argv;
+        const struct cmd_handler *handler = parse_command(cmd, &argc, &argv);
         if (!handler) {
             list_add(
                 res_list, cmd_results_new(CMD_INVALID, "Unknown/invalid command '%s'", argv[0])
@@ -199,11 +225,6 @@ execute_command(char *_exec, struct hwd_seat *seat, struct hwd_window *window) {
             goto cleanup;
         }
 
-        // Var replacement, for all but first argument of set
-        for (int i = handler->handle == cmd_set ? 2 : 1; i < argc; ++i) {
-            argv[i] = do_var_replacement(argv[i]);
-        }
-
         if (window == NULL) {
             window = root_get_focused_window(root);
         }
@@ -229,6 +250,208 @@ cleanup:
     return res_list;
 }
 
+/**
+ * Packs arguments into a single allocation, with the array of pointers
+ * followed by the strings that they point to.
+ */
+static char **
+pack_argv(int argc, char **argv, size_t *size_out) {
+    size_t size = sizeof(char *) * (argc + 1);
+    for (int i = 0; i < argc; ++i) {
+        size += strlen(argv[i]) + 1;
+    }
+
+    char **packed = malloc(size);
+    assert(packed != NULL);
+
+    char *strings = (char *)(packed + argc + 1);
+    for (int i = 0; i < argc; ++i) {
+        size_t length = strlen(argv[i]) + 1;
+        memcpy(strings, argv[i], length);
+        packed[i] = strings;
+        strings += length;
+    }
+    packed[argc] = NULL;
+
+    *size_out = size;
+    return packed;
+}
+
+static char **
+copy_packed_argv(const struct cmd_compiled_step *step) {
+    char **copy = malloc(step->argv_size);
+    assert(copy != NULL);
+    memcpy(copy, step->argv, step->argv_size);
+    for (int i = 0; i < step->argc; ++i) {
+        copy[i] = (char *)copy + (step->argv[i] - (char *)step->argv);
+    }
+    return copy;
+}
+
+static void
+cmd_compiled_clear_steps(struct cmd_compiled *compiled) {
+    for (int i = 0; i < compiled->length; ++i) {
+        free(compiled->steps[i].text);
+        free(compiled->steps[i].argv);
+    }
+    free(compiled->steps);
+    compiled->steps = NULL;
+    compiled->length = 0;
+}
+
+struct cmd_compiled *
+cmd_compiled_new(const char *source) {
+    struct cmd_compiled *compiled = calloc(1, sizeof(struct cmd_compiled));
+    assert(compiled != NULL);
+
+    compiled->refcount = 1;
+    compiled->symbols_generation = config->symbols_generation;
+    compiled->source = strdup(source);
+    assert(compiled->source != NULL);
+
+    char *exec = strdup(source);
+    assert(exec != NULL);
+    char *head = exec;
+    char matched_delim = ';';
+    int capacity = 0;
+
+    do {
+        for (; isspace(*head); ++head) {
+        }
+
+        char *cmd = argsep(&head, ";,", &matched_delim);
+        for (; isspace(*cmd); ++cmd) {
+        }
+
+        if (strcmp(cmd, "") == 0) {
+            continue;
+        }
+
+        int argc;
+        char **argv;
+        const struct cmd_handler *handler = parse_command(cmd, &argc, &argv);
+
+        if (handler && handler->handle == cmd_set) {
+            // Later commands need to see the new value of the variable, so
+            // they have to be parsed after this one has run.
+            free_argv(argc, argv);
+            compiled->dynamic = true;
+            break;
+        }
+
+        if (compiled->length == capacity) {
+            capacity = capacity ? capacity * 2 : 4;
+            compiled->steps =
+                realloc(compiled->steps, sizeof(struct cmd_compiled_step) * capacity);
+            assert(compiled->steps != NULL);
+        }
+
+        struct cmd_compiled_step *step = &compiled->steps[compiled->length++];
+        step->handler = handler;
+        step->text = strdup(cmd);
+        assert(step->text != NULL);
+        step->argc = argc;
+        step->argv = pack_argv(argc, argv, &step->argv_size);
+        free_argv(argc, argv);
+
+        if (!handler) {
+            break;
+        }
+    } while (head);
+
+    free(exec);
+
+    if (compiled->dynamic) {
+        cmd_compiled_clear_steps(compiled);
+    }
+
+    return compiled;
+}
+
+struct cmd_compiled *
+cmd_compiled_ref(struct cmd_compiled *compiled) {
+    if (compiled) {
+        compiled->refcount++;
+    }
+    return compiled;
+}
+
+void
+cmd_compiled_unref(struct cmd_compiled *compiled) {
+    if (!compiled || --compiled->refcount > 0) {
+        return;
+    }
+
+    cmd_compiled_clear_steps(compiled);
+    free(compiled->source);
+    free(compiled);
+}
+
+bool
+cmd_compiled_is_stale(const struct cmd_compiled *compiled) {
+    return compiled->symbols_generation != config->symbols_generation;
+}
+
+list_t *
+execute_compiled_command(
+    struct cmd_compiled *compiled, struct hwd_seat *seat, struct hwd_window *window
+) {
+    if (compiled->dynamic) {
+        return execute_command(compiled->source, seat, window);
+    }
+
+    if (seat == NULL) {
+        // passing a NULL seat means we just pick the default seat
+        seat = input_manager_get_default_seat();
+        assert(seat);
+    }
+
+    list_t *res_list = create_list();
+    if (!res_list) {
+        return NULL;
+    }
+
+    config->handler_context.seat = seat;
+
+    for (int i = 0; i < compiled->length; ++i) {
+        struct cmd_compiled_step *step = &compiled->steps[i];
+
+        wlr_log(WLR_INFO, "Handling command '%s'", step->text);
+        if (!step->handler) {
+            list_add(
+                res_list,
+                cmd_results_new(CMD_INVALID, "Unknown/invalid command '%s'", step->argv[0])
+            );
+            break;
+        }
+
+        if (window == NULL) {
+            window = root_get_focused_window(root);
+        }
+
+        if (window == NULL) {
+            config->handler_context.workspace = root_get_active_workspace(root);
+            config->handler_context.window = NULL;
+        } else {
+            config->handler_context.workspace = window->workspace;
+            config->handler_context.window = window;
+        }
+
+        // Handlers are free to modify their arguments, so each run gets a
+        // fresh copy.
+        char **argv = copy_packed_argv(step);
+        struct cmd_results *res = step->handler->handle(step->argc - 1, argv + 1);
+        free(argv);
+
+        list_add(res_list, res);
+        if (res->status == CMD_INVALID) {
+            break;
+        }
+    }
+
+    return res_list;
+}
+
 // this is like execute_command above, except:
 // 1) it ignores empty commands (empty lines)
 // 2) it does variable substitution
@@ -0,0 +1,45 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/commands.h"
+
+#include <stdbool.h>
+#include <strings.h>
+
+#include <hayward/config.h>
+#include <hayward/profiler.h>
+#include <hayward/tree/window.h>
+
+static const char expected_syntax[] = "Expected `allow_tearing [enable|disable|toggle]`";
+
+struct cmd_results *
+cmd_allow_tearing(int argc, char **argv) {
+    HWD_PROFILER_TRACE();
+
+    struct cmd_results *error = NULL;
+    if ((error = checkarg(argc, "allow_tearing", EXPECTED_EQUAL_TO, 1))) {
+        return error;
+    }
+    struct hwd_window *window = config->handler_context.window;
+
+    if (!window) {
+        // If the focus is not a window, do nothing successfully
+        return cmd_results_new(CMD_SUCCESS, NULL);
+    }
+
+    if (strcasecmp(argv[0], "toggle") == 0) {
+        window->allow_tearing = !window->allow_tearing;
+    } else if (strcasecmp(argv[0], "enable") == 0) {
+        window->allow_tearing = true;
+    } else if (strcasecmp(argv[0], "disable") == 0) {
+        window->allow_tearing = false;
+    } else {
+        return cmd_results_new(CMD_INVALID, expected_syntax);
+    }
+
+    // Takes effect the next time the window's output is repainted, which a
+    // client that wants to tear will be causing continuously.
+    return cmd_results_new(CMD_SUCCESS, NULL);
+}
@@ -39,6 +39,7 @@ free_hwd_binding(struct hwd_binding *binding) {
     list_free_items_and_destroy(binding->syms);
     free(binding->input);
     free(binding->command);
+    cmd_compiled_unref(binding->compiled);
     free(binding);
 }
 
@@ -498,6 +499,8 @@ cmd_bindsym_or_bindcode(int argc, char **argv, bool bindcode, bool unbind) {
         mode_bindings = config->current_mode->mouse_bindings;
     }
 
+    mode_invalidate_binding_indexes(config->current_mode);
+
     if (unbind) {
         return binding_remove(binding, mode_bindings, bindtype, argv[0]);
     }
@@ -635,6 +638,20 @@ cmd_unbindswitch(int argc, char **argv) {
     return cmd_bind_or_unbind_switch(argc, argv, true);
 }
 
+static void
+binding_log_results(const char *command, list_t *res_list) {
+    for (int i = 0; i < res_list->length; ++i) {
+        struct cmd_results *results = res_list->items[i];
+        if (results->status != CMD_SUCCESS) {
+            wlr_log(
+                WLR_DEBUG, "could not run command for binding: %s (%s)", command, results->error
+            );
+        }
+        free_cmd_results(results);
+    }
+    list_free(res_list);
+}
+
 /**
  * Execute the command associated to a binding
  */
@@ -649,6 +666,7 @@ seat_execute_command(struct hwd_seat *seat, struct hwd_binding *binding) {
         }
         memcpy(deferred, binding, sizeof(struct hwd_binding));
         deferred->command = binding->command ? strdup(binding->command) : NULL;
+        deferred->compiled = NULL;
         list_add(seat->deferred_bindings, deferred);
         return;
     }
@@ -665,18 +683,28 @@ seat_execute_command(struct hwd_seat *seat, struct hwd_binding *binding) {
         );
     }
 
-    list_t *res_list = execute_command(binding->command, seat, window);
-    for (int i = 0; i < res_list->length; ++i) {
-        struct cmd_results *results = res_list->items[i];
-        if (results->status != CMD_SUCCESS) {
-            wlr_log(
-                WLR_DEBUG, "could not run command for binding: %s (%s)", binding->command,
-                results->error
-            );
-        }
-        free_cmd_results(results);
+    // Handlers are looked up differently while the config is being read, so
+    // only compile commands that are run outside of a reload.
+    if (config->reading) {
+        list_t *res_list = execute_command(binding->command, seat, window);
+        binding_log_results(binding->command, res_list);
+        return;
     }
-    list_free(res_list);
+
+    if (binding->compiled && cmd_compiled_is_stale(binding->compiled)) {
+        cmd_compiled_unref(binding->compiled);
+        binding->compiled = NULL;
+    }
+    if (!binding->compiled) {
+        binding->compiled = cmd_compiled_new(binding->command);
+    }
+
+    // The command may free the binding, for example by unbinding it, so hold
+    // on to the compiled command until it has finished.
+    struct cmd_compiled *compiled = cmd_compiled_ref(binding->compiled);
+    list_t *res_list = execute_compiled_command(compiled, seat, window);
+    binding_log_results(compiled->source, res_list);
+    cmd_compiled_unref(compiled);
 }
 
 /**
@@ -12,8 +12,10 @@
 #include <wlr/util/log.h>
 
 #include <hayward/config.h>
+#include <hayward/ipc.h>
 #include <hayward/list.h>
 #include <hayward/profiler.h>
+#include <hayward/server.h>
 #include <hayward/stringop.h>
 
 // Must be in order for the bsearch
@@ -79,8 +81,8 @@ cmd_mode(int argc, char **argv) {
     struct hwd_mode *stored_mode = config->current_mode;
     config->current_mode = mode;
     if (argc == 1) {
-        // trigger IPC mode event
         wlr_log(WLR_DEBUG, "Switching to mode `%s' (pango=%d)", mode->name, mode->pango);
+        ipc_server_notify_mode(server.ipc);
         return cmd_results_new(CMD_SUCCESS, NULL);
     }
 
@@ -23,6 +23,7 @@ static const struct cmd_handler seat_handlers[] = {
     {"idle_inhibit", seat_cmd_idle_inhibit},
     {"idle_wake", seat_cmd_idle_wake},
     {"keyboard_grouping", seat_cmd_keyboard_grouping},
+    {"pointer_coalesce", seat_cmd_pointer_coalesce},
     {"pointer_constraint", seat_cmd_pointer_constraint},
     {"xcursor_theme", seat_cmd_xcursor_theme},
 };
@@ -0,0 +1,44 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/commands.h"
+
+#include <stdbool.h>
+
+#include <wayland-util.h>
+
+#include <hayward/config.h>
+#include <hayward/input/cursor.h>
+#include <hayward/input/input_manager.h>
+#include <hayward/input/seat.h>
+#include <hayward/profiler.h>
+#include <hayward/server.h>
+#include <hayward/util.h>
+
+// pointer_coalesce enable|disable
+struct cmd_results *
+seat_cmd_pointer_coalesce(int argc, char **argv) {
+    HWD_PROFILER_TRACE();
+
+    struct cmd_results *error = NULL;
+    if ((error = checkarg(argc, "pointer_coalesce", EXPECTED_EQUAL_TO, 1))) {
+        return error;
+    }
+    struct seat_config *seat_config = config->handler_context.seat_config;
+    if (!seat_config) {
+        return cmd_results_new(CMD_FAILURE, "No seat defined");
+    }
+
+    seat_config->pointer_coalesce =
+        parse_boolean(argv[0], false) ? POINTER_COALESCE_ENABLE : POINTER_COALESCE_DISABLE;
+
+    // Invalidate all the caches for this config
+    struct hwd_seat *seat = NULL;
+    wl_list_for_each(seat, &server.input->seats, link) {
+        seat->cursor->pointer_coalesce = POINTER_COALESCE_DEFAULT;
+    }
+
+    return cmd_results_new(CMD_SUCCESS, NULL);
+}
@@ -6,30 +6,11 @@
 #include "hayward/commands.h"
 
 #include <stdlib.h>
-#include <string.h>
 
 #include <hayward/config.h>
-#include <hayward/list.h>
 #include <hayward/profiler.h>
 #include <hayward/stringop.h>
-
-// sort in order of longest->shortest
-static int
-compare_set_qsort(const void *_l, const void *_r) {
-    struct hwd_variable const *l = *(void **)_l;
-    struct hwd_variable const *r = *(void **)_r;
-    return strlen(r->name) - strlen(l->name);
-}
-
-void
-free_hwd_variable(struct hwd_variable *var) {
-    if (!var) {
-        return;
-    }
-    free(var->name);
-    free(var->value);
-    free(var);
-}
+#include <hayward/variables.h>
 
 struct cmd_results *
 cmd_set(int argc, char **argv) {
@@ -44,27 +25,9 @@ cmd_set(int argc, char **argv) {
         return cmd_results_new(CMD_INVALID, "variable '%s' must start with $", argv[0]);
     }
 
-    struct hwd_variable *var = NULL;
-    // Find old variable if it exists
-    int i;
-    for (i = 0; i < config->symbols->length; ++i) {
-        var = config->symbols->items[i];
-        if (strcmp(var->name, argv[0]) == 0) {
-            break;
-        }
-        var = NULL;
-    }
-    if (var) {
-        free(var->value);
-    } else {
-        var = malloc(sizeof(struct hwd_variable));
-        if (!var) {
-            return cmd_results_new(CMD_FAILURE, "Unable to allocate variable");
-        }
-        var->name = strdup(argv[0]);
-        list_add(config->symbols, var);
-        list_qsort(config->symbols, compare_set_qsort);
-    }
-    var->value = join_args(argv + 1, argc - 1);
+    char *value = join_args(argv + 1, argc - 1);
+    hwd_variables_set(config->symbols, argv[0], value);
+    free(value);
+    config->symbols_generation++;
     return cmd_results_new(CMD_SUCCESS, NULL);
 }
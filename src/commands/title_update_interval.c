@@ -0,0 +1,31 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/commands.h"
+
+#include <stdlib.h>
+
+#include <hayward/config.h>
+#include <hayward/profiler.h>
+
+struct cmd_results *
+cmd_title_update_interval(int argc, char **argv) {
+    HWD_PROFILER_TRACE();
+
+    struct cmd_results *error = NULL;
+    if ((error = checkarg(argc, "title_update_interval", EXPECTED_EQUAL_TO, 1))) {
+        return error;
+    }
+
+    char *inv;
+    int value = strtol(argv[0], &inv, 10);
+    if (*inv != '\0' || value < 0) {
+        return cmd_results_new(CMD_INVALID, "Invalid interval specified");
+    }
+
+    config->title_update_interval = value;
+
+    return cmd_results_new(CMD_SUCCESS, NULL);
+}
@@ -11,6 +11,7 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -27,6 +28,7 @@
 #include <wlr/types/wlr_seat.h>
 #include <wlr/util/log.h>
 
+#include <hayward/binding_index.h>
 #include <hayward/commands.h>
 #include <hayward/globals/root.h>
 #include <hayward/haywardnag.h>
@@ -38,6 +40,7 @@
 #include <hayward/server.h>
 #include <hayward/stringop.h>
 #include <hayward/tree/root.h>
+#include <hayward/variables.h>
 
 struct hwd_config *config = NULL;
 
@@ -54,6 +57,12 @@ keysym_translation_state_create(struct xkb_rule_names rules) {
     return xkb_state_new(xkb_keymap);
 }
 
+static struct xkb_state *
+keysym_translation_state_copy(struct xkb_state *state) {
+    struct xkb_keymap *xkb_keymap = xkb_keymap_ref(xkb_state_get_keymap(state));
+    return xkb_state_new(xkb_keymap);
+}
+
 static void
 keysym_translation_state_destroy(struct xkb_state *state) {
     xkb_keymap_unref(xkb_state_get_keymap(state));
@@ -66,6 +75,7 @@ free_mode(struct hwd_mode *mode) {
         return;
     }
     free(mode->name);
+    mode_invalidate_binding_indexes(mode);
     if (mode->keysym_bindings) {
         for (int i = 0; i < mode->keysym_bindings->length; i++) {
             free_hwd_binding(mode->keysym_bindings->items[i]);
@@ -129,8 +139,7 @@ config_defaults(struct hwd_config *config) {
         "--button-no-terminal 'Reload hayward' 'haywardmsg reload'";
     config->haywardnag_config_errors.detailed = true;
 
-    if (!(config->symbols = create_list()))
-        goto cleanup;
+    config->symbols = hwd_variables_create();
     if (!(config->modes = create_list()))
         goto cleanup;
     if (!(config->criteria = create_list()))
@@ -150,7 +159,7 @@ config_defaults(struct hwd_config *config) {
     if (!(config->cmd_queue = create_list()))
         goto cleanup;
 
-    if (!(config->current_mode = malloc(sizeof(struct hwd_mode))))
+    if (!(config->current_mode = calloc(1, sizeof(struct hwd_mode))))
         goto cleanup;
     if (!(config->current_mode->name = malloc(sizeof("default"))))
         goto cleanup;
@@ -190,6 +199,7 @@ config_defaults(struct hwd_config *config) {
     config->reading = false;
     config->show_marks = true;
     config->tiling_drag_threshold = 9;
+    config->title_update_interval = 50;
 
     if (!(config->config_chain = create_list()))
         goto cleanup;
@@ -343,12 +353,17 @@ load_main_config(const char *file, bool is_active, bool validating) {
         );
         config->xwayland = old_config->xwayland;
 
+        // Translate bindings with the keymap that the old config ended up
+        // using.  Unless the new config asks for a different keymap, they will
+        // not need to be translated again once it has been read.
+        keysym_translation_state_destroy(config->keysym_translation_state);
+        config->keysym_translation_state =
+            keysym_translation_state_copy(old_config->keysym_translation_state);
+
         if (!config->validating) {
             if (old_config->haywardnag_config_errors.client != NULL) {
                 wl_client_destroy(old_config->haywardnag_config_errors.client);
             }
-
-            input_manager_reset_all_inputs();
         }
     }
 
@@ -371,18 +386,7 @@ load_main_config(const char *file, bool is_active, bool validating) {
 
     if (is_active && !validating) {
         input_manager_verify_fallback_seat();
-
-        for (int i = 0; i < config->input_configs->length; i++) {
-            input_manager_apply_input_config(config->input_configs->items[i]);
-        }
-
-        for (int i = 0; i < config->input_type_configs->length; i++) {
-            input_manager_apply_input_config(config->input_type_configs->items[i]);
-        }
-
-        for (int i = 0; i < config->seat_configs->length; i++) {
-            input_manager_apply_seat_config(config->seat_configs->items[i]);
-        }
+        input_manager_apply_reloaded_config(old_config);
         hwd_switch_retrigger_bindings_for_all();
 
         config->reloading = false;
@@ -767,12 +771,7 @@ free_config(struct hwd_config *config) {
     memset(&config->handler_context, 0, sizeof(config->handler_context));
 
     // TODO: handle all currently unhandled lists as we add implementations
-    if (config->symbols) {
-        for (int i = 0; i < config->symbols->length; ++i) {
-            free_hwd_variable(config->symbols->items[i]);
-        }
-        list_free(config->symbols);
-    }
+    hwd_variables_destroy(config->symbols);
     if (config->modes) {
         for (int i = 0; i < config->modes->length; ++i) {
             free_mode(config->modes->items[i]);
@@ -810,57 +809,21 @@ free_config(struct hwd_config *config) {
 
 char *
 do_var_replacement(char *str) {
-    int i;
-    char *find = str;
-    while ((find = strchr(find, '$'))) {
-        // Skip if escaped.
-        if (find > str && find[-1] == '\\') {
-            if (find == str + 1 || !(find > str + 1 && find[-2] == '\\')) {
-                ++find;
-                continue;
-            }
-        }
-        // Unescape double $ and move on
-        if (find[1] == '$') {
-            size_t length = strlen(find + 1);
-            memmove(find, find + 1, length);
-            find[length] = '\0';
-            ++find;
-            continue;
-        }
-        // Find matching variable
-        for (i = 0; i < config->symbols->length; ++i) {
-            struct hwd_variable *var = config->symbols->items[i];
-            int vnlen = strlen(var->name);
-            if (strncmp(find, var->name, vnlen) == 0) {
-                int vvlen = strlen(var->value);
-                char *newstr = malloc(strlen(str) - vnlen + vvlen + 1);
-                if (!newstr) {
-                    wlr_log(
-                        WLR_ERROR,
-                        "Unable to allocate replacement "
-                        "during variable expansion"
-                    );
-                    break;
-                }
-                char *newptr = newstr;
-                int offset = find - str;
-                strncpy(newptr, str, offset);
-                newptr += offset;
-                strncpy(newptr, var->value, vvlen);
-                newptr += vvlen;
-                strcpy(newptr, find + vnlen);
-                free(str);
-                str = newstr;
-                find = str + offset + vvlen;
-                break;
-            }
-        }
-        if (i == config->symbols->length) {
-            ++find;
-        }
+    if (!strchr(str, '$')) {
+        return str;
     }
-    return str;
+
+    char *expanded = hwd_variables_expand(config->symbols, str);
+    free(str);
+    return expanded;
+}
+
+void
+mode_invalidate_binding_indexes(struct hwd_mode *mode) {
+    hwd_binding_index_destroy(mode->keysym_index);
+    mode->keysym_index = NULL;
+    hwd_binding_index_destroy(mode->keycode_index);
+    mode->keycode_index = NULL;
 }
 
 void
@@ -899,8 +862,11 @@ translate_keysyms(struct input_config *input_config) {
     keysym_translation_state_destroy(config->keysym_translation_state);
 
     struct xkb_rule_names rules = {0};
-    input_config_fill_rule_names(input_config, &rules);
+    if (input_config != NULL) {
+        input_config_fill_rule_names(input_config, &rules);
+    }
     config->keysym_translation_state = keysym_translation_state_create(rules);
+    config->keysym_translation_config = input_config;
 
     for (int i = 0; i < config->modes->length; ++i) {
         struct hwd_mode *mode = config->modes->items[i];
@@ -916,7 +882,130 @@ translate_keysyms(struct input_config *input_config) {
 
         mode->keysym_bindings = bindsyms;
         mode->keycode_bindings = bindcodes;
+
+        mode_invalidate_binding_indexes(mode);
+    }
+
+    wlr_log(
+        WLR_DEBUG, "Translated keysyms using config for device '%s'",
+        input_config != NULL ? input_config->identifier : "(default)"
+    );
+}
+
+static bool
+rule_name_equal(const char *a, const char *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+static bool
+rule_names_equal(const struct xkb_rule_names *a, const struct xkb_rule_names *b) {
+    return rule_name_equal(a->rules, b->rules) && rule_name_equal(a->model, b->model) &&
+        rule_name_equal(a->layout, b->layout) && rule_name_equal(a->variant, b->variant) &&
+        rule_name_equal(a->options, b->options);
+}
+
+static bool
+key_list_equal(list_t *a, list_t *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    if (a->length != b->length) {
+        return false;
+    }
+    for (int i = 0; i < a->length; ++i) {
+        if (*(uint32_t *)a->items[i] != *(uint32_t *)b->items[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Returns true if both lists hold equivalent bindings in the same positions.
+ * The `order` field is not compared, as it changes every time the config is
+ * read.
+ */
+static bool
+binding_list_equal(list_t *a, list_t *b) {
+    if (a->length != b->length) {
+        return false;
     }
+    for (int i = 0; i < a->length; ++i) {
+        struct hwd_binding *binding_a = a->items[i];
+        struct hwd_binding *binding_b = b->items[i];
+        if (binding_a->type != binding_b->type || binding_a->flags != binding_b->flags ||
+            binding_a->modifiers != binding_b->modifiers || binding_a->group != binding_b->group ||
+            strcmp(binding_a->input, binding_b->input) != 0 ||
+            strcmp(binding_a->command, binding_b->command) != 0 ||
+            !key_list_equal(binding_a->keys, binding_b->keys) ||
+            !key_list_equal(binding_a->syms, binding_b->syms)) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    wlr_log(WLR_DEBUG, "Translated keysyms using config for device '%s'", input_config->identifier);
+static struct hwd_mode *
+find_mode(struct hwd_config *config, const char *name) {
+    for (int i = 0; i < config->modes->length; ++i) {
+        struct hwd_mode *mode = config->modes->items[i];
+        if (strcmp(mode->name, name) == 0) {
+            return mode;
+        }
+    }
+    return NULL;
+}
+
+void
+translate_reloaded_keysyms(struct hwd_config *old_config, struct input_config *input_config) {
+    struct xkb_rule_names old_rules = {0};
+    if (old_config->keysym_translation_config != NULL) {
+        input_config_fill_rule_names(old_config->keysym_translation_config, &old_rules);
+    }
+    struct xkb_rule_names new_rules = {0};
+    if (input_config != NULL) {
+        input_config_fill_rule_names(input_config, &new_rules);
+    }
+
+    // The new config's bindings were translated with the old config's keymap
+    // while they were being read.
+    if (rule_names_equal(&old_rules, &new_rules)) {
+        config->keysym_translation_config = input_config;
+    } else {
+        translate_keysyms(input_config);
+    }
+
+    // Modes with the same key bindings as before take over the old bindings,
+    // along with their indexes and compiled commands, rather than building
+    // them again.
+    for (int i = 0; i < config->modes->length; ++i) {
+        struct hwd_mode *mode = config->modes->items[i];
+        struct hwd_mode *old_mode = find_mode(old_config, mode->name);
+        if (old_mode == NULL ||
+            !binding_list_equal(mode->keysym_bindings, old_mode->keysym_bindings) ||
+            !binding_list_equal(mode->keycode_bindings, old_mode->keycode_bindings)) {
+            continue;
+        }
+
+        list_t *keysym_bindings = mode->keysym_bindings;
+        mode->keysym_bindings = old_mode->keysym_bindings;
+        old_mode->keysym_bindings = keysym_bindings;
+
+        list_t *keycode_bindings = mode->keycode_bindings;
+        mode->keycode_bindings = old_mode->keycode_bindings;
+        old_mode->keycode_bindings = keycode_bindings;
+
+        struct hwd_binding_index *keysym_index = mode->keysym_index;
+        mode->keysym_index = old_mode->keysym_index;
+        old_mode->keysym_index = keysym_index;
+
+        struct hwd_binding_index *keycode_index = mode->keycode_index;
+        mode->keycode_index = old_mode->keycode_index;
+        old_mode->keycode_index = keycode_index;
+
+        wlr_log(WLR_DEBUG, "Keeping key bindings for unchanged mode '%s'", mode->name);
+    }
 }
@@ -404,3 +404,99 @@ free_input_config(struct input_config *ic) {
     list_free_items_and_destroy(ic->tools);
     free(ic);
 }
+
+static bool
+input_config_str_equal(const char *a, const char *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+bool
+input_config_equal(const struct input_config *a, const struct input_config *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+
+    if (a->xkb_file || b->xkb_file) {
+        return false;
+    }
+
+    if (a->accel_profile != b->accel_profile || a->click_method != b->click_method ||
+        a->drag != b->drag || a->drag_lock != b->drag_lock || a->dwt != b->dwt ||
+        a->left_handed != b->left_handed || a->middle_emulation != b->middle_emulation ||
+        a->natural_scroll != b->natural_scroll || a->pointer_accel != b->pointer_accel ||
+        a->scroll_factor != b->scroll_factor || a->repeat_delay != b->repeat_delay ||
+        a->repeat_rate != b->repeat_rate || a->scroll_button != b->scroll_button ||
+        a->scroll_method != b->scroll_method || a->send_events != b->send_events ||
+        a->tap != b->tap || a->tap_button_map != b->tap_button_map ||
+        a->xkb_numlock != b->xkb_numlock || a->xkb_capslock != b->xkb_capslock ||
+        a->mapped_to != b->mapped_to || a->capturable != b->capturable) {
+        return false;
+    }
+
+    if (!input_config_str_equal(a->xkb_layout, b->xkb_layout) ||
+        !input_config_str_equal(a->xkb_model, b->xkb_model) ||
+        !input_config_str_equal(a->xkb_options, b->xkb_options) ||
+        !input_config_str_equal(a->xkb_rules, b->xkb_rules) ||
+        !input_config_str_equal(a->xkb_variant, b->xkb_variant) ||
+        !input_config_str_equal(a->mapped_to_output, b->mapped_to_output)) {
+        return false;
+    }
+
+    if (a->calibration_matrix.configured != b->calibration_matrix.configured) {
+        return false;
+    }
+    if (a->calibration_matrix.configured &&
+        memcmp(
+            a->calibration_matrix.matrix, b->calibration_matrix.matrix,
+            sizeof(a->calibration_matrix.matrix)
+        ) != 0) {
+        return false;
+    }
+
+    const struct input_config_mapped_from_region *a_from = a->mapped_from_region;
+    const struct input_config_mapped_from_region *b_from = b->mapped_from_region;
+    if (a_from == NULL || b_from == NULL) {
+        if (a_from != b_from) {
+            return false;
+        }
+    } else if (a_from->x1 != b_from->x1 || a_from->y1 != b_from->y1 ||
+               a_from->x2 != b_from->x2 || a_from->y2 != b_from->y2 || a_from->mm != b_from->mm) {
+        return false;
+    }
+
+    if (a->mapped_to_region == NULL || b->mapped_to_region == NULL) {
+        if (a->mapped_to_region != b->mapped_to_region) {
+            return false;
+        }
+    } else if (!wlr_box_equal(a->mapped_to_region, b->mapped_to_region)) {
+        return false;
+    }
+
+    if (!wlr_box_equal(&a->region, &b->region)) {
+        return false;
+    }
+
+    // Tools are merged by type, so each type appears at most once.
+    if (a->tools->length != b->tools->length) {
+        return false;
+    }
+    for (int i = 0; i < a->tools->length; i++) {
+        struct input_config_tool *a_tool = a->tools->items[i];
+        bool found = false;
+        for (int j = 0; j < b->tools->length; j++) {
+            struct input_config_tool *b_tool = b->tools->items[j];
+            if (a_tool->type == b_tool->type) {
+                found = a_tool->mode == b_tool->mode;
+                break;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -37,6 +37,7 @@ new_seat_config(const char *name) {
     seat->hide_cursor_timeout = -1;
     seat->hide_cursor_when_typing = HIDE_WHEN_TYPING_DEFAULT;
     seat->allow_constrain = CONSTRAIN_DEFAULT;
+    seat->pointer_coalesce = POINTER_COALESCE_DEFAULT;
     seat->keyboard_grouping = KEYBOARD_GROUP_DEFAULT;
     seat->xcursor_theme.name = NULL;
     seat->xcursor_theme.size = 24;
@@ -165,6 +166,10 @@ merge_seat_config(struct seat_config *dest, struct seat_config *source) {
         dest->allow_constrain = source->allow_constrain;
     }
 
+    if (source->pointer_coalesce != POINTER_COALESCE_DEFAULT) {
+        dest->pointer_coalesce = source->pointer_coalesce;
+    }
+
     if (source->keyboard_grouping != KEYBOARD_GROUP_DEFAULT) {
         dest->keyboard_grouping = source->keyboard_grouping;
     }
@@ -199,6 +204,45 @@ free_seat_config(struct seat_config *seat) {
     free(seat);
 }
 
+bool
+seat_config_equal(const struct seat_config *a, const struct seat_config *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+
+    if (strcmp(a->name, b->name) != 0 || a->fallback != b->fallback ||
+        a->hide_cursor_timeout != b->hide_cursor_timeout ||
+        a->hide_cursor_when_typing != b->hide_cursor_when_typing ||
+        a->allow_constrain != b->allow_constrain || a->pointer_coalesce != b->pointer_coalesce ||
+        a->keyboard_grouping != b->keyboard_grouping ||
+        a->idle_inhibit_sources != b->idle_inhibit_sources ||
+        a->idle_wake_sources != b->idle_wake_sources ||
+        a->xcursor_theme.size != b->xcursor_theme.size) {
+        return false;
+    }
+
+    if (a->xcursor_theme.name == NULL || b->xcursor_theme.name == NULL) {
+        if (a->xcursor_theme.name != b->xcursor_theme.name) {
+            return false;
+        }
+    } else if (strcmp(a->xcursor_theme.name, b->xcursor_theme.name) != 0) {
+        return false;
+    }
+
+    if (a->attachments->length != b->attachments->length) {
+        return false;
+    }
+    for (int i = 0; i < a->attachments->length; ++i) {
+        struct seat_attachment_config *a_attachment = a->attachments->items[i];
+        struct seat_attachment_config *b_attachment = b->attachments->items[i];
+        if (strcmp(a_attachment->identifier, b_attachment->identifier) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int
 seat_name_cmp(const void *item, const void *data) {
     const struct seat_config *sc = item;
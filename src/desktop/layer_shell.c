@@ -75,6 +75,9 @@ arrange_layers(struct hwd_output *output) {
     arrange_surface(output, &full_area, &usable_area, output->layers.shell_top);
     arrange_surface(output, &full_area, &usable_area, output->layers.shell_overlay);
 
+    // Layer surfaces can be moved by output changes without committing.
+    root->scene_generation++;
+
     if (!wlr_box_equal(&usable_area, &output->usable_area)) {
         wlr_log(WLR_DEBUG, "Usable area changed, rearranging output");
         output->usable_area = usable_area;
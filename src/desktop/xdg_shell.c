@@ -392,7 +392,16 @@ hwd_xdg_shell_view_handle_wlr_xdg_toplevel_set_title(struct wl_listener *listene
 }
 
 static void
-hwd_xdg_shell_view_handle_wlr_xdg_toplevel_set_app_id(struct wl_listener *listener, void *data) {}
+hwd_xdg_shell_view_handle_wlr_xdg_toplevel_set_app_id(struct wl_listener *listener, void *data) {
+    struct hwd_xdg_shell_view *self = wl_container_of(listener, self, wlr_xdg_toplevel_set_app_id);
+
+    struct hwd_window *window = self->window;
+    if (window == NULL) {
+        return;
+    }
+
+    window_set_app_id(window, self->wlr_xdg_toplevel->app_id);
+}
 
 static void
 hwd_xdg_shell_view_handle_wlr_xdg_toplevel_set_parent(struct wl_listener *listener, void *data) {
@@ -596,6 +605,13 @@ hwd_xdg_shell_view_handle_wlr_surface_map(struct wl_listener *listener, void *da
     }
     window_set_natural_size(self->window, natural_width, natural_height);
 
+    // Clients usually set these before mapping, while there was no window to
+    // forward them to.
+    if (toplevel->title != NULL) {
+        window_set_title(self->window, toplevel->title);
+    }
+    window_set_app_id(self->window, toplevel->app_id);
+
     if (wants_floating(self)) {
         workspace_add_floating(workspace, self->window);
     } else {
@@ -27,6 +27,7 @@
 #include <wlr/xwayland/xwayland.h>
 
 #include <hayward/globals/root.h>
+#include <hayward/input/cursor_theme.h>
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
 #include <hayward/input/seatop_move.h>
@@ -78,6 +79,9 @@ hwd_xwayland_unmanaged_handle_xsurface_set_geometry(struct wl_listener *listener
     struct wlr_xwayland_surface *xsurface = self->wlr_xwayland_surface;
 
     wlr_scene_node_set_position(&self->surface_scene->buffer->node, xsurface->x, xsurface->y);
+
+    // X11 clients can move windows without committing a new buffer.
+    root->scene_generation++;
 }
 
 static void
@@ -95,6 +99,7 @@ hwd_xwayland_unmanaged_handle_xsurface_map(struct wl_listener *listener, void *d
         );
 
         wlr_scene_node_set_position(&self->surface_scene->buffer->node, xsurface->x, xsurface->y);
+        root->scene_generation++;
 
         wl_signal_add(&xsurface->events.set_geometry, &self->xsurface_set_geometry);
         self->xsurface_set_geometry.notify = hwd_xwayland_unmanaged_handle_xsurface_set_geometry;
@@ -122,6 +127,7 @@ hwd_xwayland_unmanaged_handle_xsurface_unmap(struct wl_listener *listener, void
 
         wlr_scene_node_destroy(&self->surface_scene->buffer->node);
         self->surface_scene = NULL;
+        root->scene_generation++;
     }
 
     struct hwd_seat *seat = input_manager_current_seat();
@@ -618,6 +624,7 @@ hwd_xwayland_view_handle_xsurface_map(struct wl_listener *listener, void *data)
         title = "";
     }
     window_set_title(self->window, title);
+    window_set_app_id(self->window, self->wlr_xwayland_surface->class);
 
     struct hwd_xwayland_view *new_parent = NULL;
     if (xsurface->parent != NULL) {
@@ -791,7 +798,14 @@ hwd_xwayland_view_handle_xsurface_set_title(struct wl_listener *listener, void *
 
 static void
 hwd_xwayland_view_handle_xsurface_set_class(struct wl_listener *listener, void *data) {
-    // TODO probably remove.
+    struct hwd_xwayland_view *self = wl_container_of(listener, self, xsurface_set_class);
+
+    struct hwd_window *window = self->window;
+    if (window == NULL) {
+        return;
+    }
+
+    window_set_app_id(window, self->wlr_xwayland_surface->class);
 }
 
 static void
@@ -980,6 +994,7 @@ hwd_xwayland_create(struct wl_display *wl_display, struct wlr_compositor *compos
 
 void
 hwd_xwayland_destroy(struct hwd_xwayland *self) {
+    cursor_theme_unref(self->xcursor_theme);
     wlr_xwayland_destroy(self->xwayland);
     free(self);
 }
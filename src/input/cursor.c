@@ -24,6 +24,7 @@
 #include <wayland-server-protocol.h>
 #include <wayland-util.h>
 
+#include <wlr/types/wlr_buffer.h>
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_cursor.h>
 #include <wlr/types/wlr_input_device.h>
@@ -49,9 +50,11 @@
 #include <hayward/desktop/layer_shell.h>
 #include <hayward/desktop/xdg_shell.h>
 #include <hayward/globals/root.h>
+#include <hayward/input/cursor_theme.h>
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
 #include <hayward/input/tablet.h>
+#include <hayward/latency.h>
 #include <hayward/server.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
@@ -88,92 +91,321 @@ scene_node_try_get_surface(struct wlr_scene_node *scene_node) {
     return scene_surface->surface;
 }
 
-/**
- * Reports whatever objects are directly under the cursor coordinates.
- * If the coordinates do not point inside an output then nothing will be
- * returned.  If the cursor is not over anything then window and surface
- * will be set to NULL.  If surface is not a view then window will be NULL.
- */
-void
-seat_get_target_at(
-    struct hwd_seat *seat, double lx, double ly, struct hwd_output **output_out,
-    struct hwd_window **window_out, struct wlr_surface **surface_out, double *sx_out, double *sy_out
+static struct wlr_scene_node *
+scene_get_target_at(
+    double lx, double ly, struct hwd_window **window_out, struct wlr_surface **surface_out,
+    double *sx_out, double *sy_out
 ) {
-    *output_out = NULL;
-    *window_out = NULL;
-    *surface_out = NULL;
-    *sx_out = 0;
-    *sy_out = 0;
-
-    // Find the output the cursor is on.
-    struct wlr_output *wlr_output = wlr_output_layout_output_at(root->output_layout, lx, ly);
-    if (wlr_output == NULL) {
-        return;
-    }
-
-    struct hwd_output *output = wlr_output->data;
-    if (!output || !output->enabled) {
-        // Output is being destroyed or is being enabled.
-        return;
-    }
-    *output_out = output;
-
+    struct wlr_scene_node *hit;
     struct wlr_scene_node *scene_node;
 
     // Trace through parents to find first one that we recognize.
-    scene_node = wlr_scene_node_at(&root->layers.popups->node, lx, ly, sx_out, sy_out);
-    *surface_out = scene_node_try_get_surface(scene_node);
-    if (scene_node != NULL) {
-        return;
+    hit = wlr_scene_node_at(&root->layers.popups->node, lx, ly, sx_out, sy_out);
+    *surface_out = scene_node_try_get_surface(hit);
+    if (hit != NULL) {
+        return hit;
     }
 
-    scene_node = wlr_scene_node_at(&root->layers.overlay->node, lx, ly, sx_out, sy_out);
-    *surface_out = scene_node_try_get_surface(scene_node);
+    hit = wlr_scene_node_at(&root->layers.overlay->node, lx, ly, sx_out, sy_out);
+    *surface_out = scene_node_try_get_surface(hit);
+    scene_node = hit;
     while (scene_node != NULL) {
         struct hwd_window *window = window_for_scene_node(scene_node);
         if (window != NULL) {
             *window_out = window;
-            return;
+            return hit;
         }
 
         struct hwd_layer_surface *layer_surface = layer_surface_for_scene_node(scene_node);
         if (layer_surface != NULL) {
-            return;
+            return hit;
         }
 
         scene_node = &scene_node->parent->node;
     }
 
-    scene_node = wlr_scene_node_at(&root->layers.unmanaged->node, lx, ly, sx_out, sy_out);
-    *surface_out = scene_node_try_get_surface(scene_node);
-    if (scene_node != NULL) {
-        return;
+    hit = wlr_scene_node_at(&root->layers.unmanaged->node, lx, ly, sx_out, sy_out);
+    *surface_out = scene_node_try_get_surface(hit);
+    if (hit != NULL) {
+        return hit;
     }
 
-    scene_node = wlr_scene_node_at(&root->layers.workspaces->node, lx, ly, sx_out, sy_out);
-    *surface_out = scene_node_try_get_surface(scene_node);
+    hit = wlr_scene_node_at(&root->layers.workspaces->node, lx, ly, sx_out, sy_out);
+    *surface_out = scene_node_try_get_surface(hit);
+    scene_node = hit;
     while (scene_node != NULL) {
         struct hwd_window *window = window_for_scene_node(scene_node);
         if (window != NULL) {
             *window_out = window;
-            return;
+            return hit;
         }
 
         scene_node = &scene_node->parent->node;
     }
 
-    scene_node = wlr_scene_node_at(&root->layers.background->node, lx, ly, sx_out, sy_out);
-    *surface_out = scene_node_try_get_surface(scene_node);
+    hit = wlr_scene_node_at(&root->layers.background->node, lx, ly, sx_out, sy_out);
+    *surface_out = scene_node_try_get_surface(hit);
+    scene_node = hit;
     while (scene_node != NULL) {
         struct hwd_layer_surface *layer_surface = layer_surface_for_scene_node(scene_node);
         if (layer_surface != NULL) {
-            return;
+            return hit;
         }
 
         scene_node = &scene_node->parent->node;
     }
 
     *surface_out = NULL;
+    return NULL;
+}
+
+static void
+cursor_target_cache_invalidate(struct hwd_cursor *cursor) {
+    struct hwd_cursor_target_cache *cache = &cursor->target_cache;
+
+    cache->valid = false;
+    cache->output = NULL;
+    cache->window = NULL;
+    cache->surface = NULL;
+
+    wl_list_remove(&cache->surface_commit.link);
+    wl_list_init(&cache->surface_commit.link);
+    wl_list_remove(&cache->surface_destroy.link);
+    wl_list_init(&cache->surface_destroy.link);
+}
+
+static void
+handle_target_cache_surface_commit(struct wl_listener *listener, void *data) {
+    struct hwd_cursor *cursor = wl_container_of(listener, cursor, target_cache.surface_commit);
+    cursor_target_cache_invalidate(cursor);
+}
+
+static void
+handle_target_cache_surface_destroy(struct wl_listener *listener, void *data) {
+    struct hwd_cursor *cursor = wl_container_of(listener, cursor, target_cache.surface_destroy);
+    cursor_target_cache_invalidate(cursor);
+}
+
+/**
+ * Shrinks `box` so that it no longer overlaps `other`, while still containing
+ * the point `lx`, `ly`.  If that isn't possible then `box` will be left empty.
+ */
+static void
+target_box_exclude(struct wlr_box *box, double lx, double ly, const struct wlr_box *other) {
+    struct wlr_box intersection;
+    if (!wlr_box_intersection(&intersection, box, other)) {
+        return;
+    }
+
+    struct wlr_box best = {0};
+    struct wlr_box candidate;
+
+    if (lx < other->x) {
+        candidate = *box;
+        candidate.width = other->x - box->x;
+        if (candidate.width * candidate.height > best.width * best.height) {
+            best = candidate;
+        }
+    }
+    if (lx >= other->x + other->width) {
+        candidate = *box;
+        candidate.x = other->x + other->width;
+        candidate.width = box->x + box->width - candidate.x;
+        if (candidate.width * candidate.height > best.width * best.height) {
+            best = candidate;
+        }
+    }
+    if (ly < other->y) {
+        candidate = *box;
+        candidate.height = other->y - box->y;
+        if (candidate.width * candidate.height > best.width * best.height) {
+            best = candidate;
+        }
+    }
+    if (ly >= other->y + other->height) {
+        candidate = *box;
+        candidate.y = other->y + other->height;
+        candidate.height = box->y + box->height - candidate.y;
+        if (candidate.width * candidate.height > best.width * best.height) {
+            best = candidate;
+        }
+    }
+
+    *box = best;
+}
+
+/**
+ * Removes the area covered by `node`, and all of its descendants, from `box`.
+ * `x` and `y` are the layout coordinates of the node's parent.
+ */
+static void
+target_box_exclude_node(
+    struct wlr_box *box, double lx, double ly, struct wlr_scene_node *node, int x, int y
+) {
+    if (!node->enabled || wlr_box_empty(box)) {
+        return;
+    }
+
+    struct wlr_box other = {.x = x + node->x, .y = y + node->y};
+
+    switch (node->type) {
+    case WLR_SCENE_NODE_TREE: {
+        struct wlr_scene_tree *tree = wlr_scene_tree_from_node(node);
+        struct wlr_scene_node *child;
+        wl_list_for_each(child, &tree->children, link) {
+            target_box_exclude_node(box, lx, ly, child, other.x, other.y);
+        }
+        return;
+    }
+    case WLR_SCENE_NODE_RECT: {
+        struct wlr_scene_rect *rect = wlr_scene_rect_from_node(node);
+        other.width = rect->width;
+        other.height = rect->height;
+        break;
+    }
+    case WLR_SCENE_NODE_BUFFER: {
+        struct wlr_scene_buffer *buffer = wlr_scene_buffer_from_node(node);
+        if (buffer->dst_width > 0 && buffer->dst_height > 0) {
+            other.width = buffer->dst_width;
+            other.height = buffer->dst_height;
+        } else if (buffer->buffer != NULL) {
+            other.width = buffer->buffer->width;
+            other.height = buffer->buffer->height;
+            if (buffer->transform & WL_OUTPUT_TRANSFORM_90) {
+                other.width = buffer->buffer->height;
+                other.height = buffer->buffer->width;
+            }
+        }
+        break;
+    }
+    }
+
+    target_box_exclude(box, lx, ly, &other);
+}
+
+static void
+cursor_target_cache_update(
+    struct hwd_cursor *cursor, double lx, double ly, struct hwd_output *output,
+    struct wlr_scene_node *hit, struct hwd_window *window, struct wlr_surface *surface, double sx,
+    double sy
+) {
+    struct hwd_cursor_target_cache *cache = &cursor->target_cache;
+
+    cursor_target_cache_invalidate(cursor);
+
+    if (surface == NULL) {
+        return;
+    }
+
+    int buffer_x, buffer_y;
+    if (!wlr_scene_node_coords(hit, &buffer_x, &buffer_y)) {
+        return;
+    }
+
+    struct wlr_scene_buffer *buffer = wlr_scene_buffer_from_node(hit);
+    struct wlr_box box = {
+        .x = buffer_x,
+        .y = buffer_y,
+        .width = buffer->dst_width,
+        .height = buffer->dst_height,
+    };
+
+    // Walk everything that is drawn above the surface and cut it out of the
+    // box.  This costs about the same as a lookup, but only needs to be done
+    // once each time the cursor enters a surface.
+    struct wlr_scene_node *node = hit;
+    while (node->parent != NULL && !wlr_box_empty(&box)) {
+        struct wlr_scene_tree *parent = node->parent;
+
+        int parent_x, parent_y;
+        wlr_scene_node_coords(&parent->node, &parent_x, &parent_y);
+
+        struct wl_list *link = node->link.next;
+        while (link != &parent->children) {
+            struct wlr_scene_node *sibling = wl_container_of(link, sibling, link);
+            link = link->next;
+
+            // Windows that are being moved are never targeted.
+            if (sibling == &root->layers.moving->node) {
+                continue;
+            }
+
+            target_box_exclude_node(&box, lx, ly, sibling, parent_x, parent_y);
+        }
+
+        node = &parent->node;
+    }
+
+    if (wlr_box_empty(&box)) {
+        return;
+    }
+
+    cache->valid = true;
+    cache->scene_generation = root->scene_generation;
+    cache->box = box;
+    cache->surface_x = lx - sx;
+    cache->surface_y = ly - sy;
+    cache->output = output;
+    cache->window = window;
+    cache->surface = surface;
+
+    wl_signal_add(&surface->events.commit, &cache->surface_commit);
+    wl_signal_add(&surface->events.destroy, &cache->surface_destroy);
+}
+
+/**
+ * Reports whatever objects are directly under the cursor coordinates.
+ * If the coordinates do not point inside an output then nothing will be
+ * returned.  If the cursor is not over anything then window and surface
+ * will be set to NULL.  If surface is not a view then window will be NULL.
+ */
+void
+seat_get_target_at(
+    struct hwd_seat *seat, double lx, double ly, struct hwd_output **output_out,
+    struct hwd_window **window_out, struct wlr_surface **surface_out, double *sx_out, double *sy_out
+) {
+    *output_out = NULL;
+    *window_out = NULL;
+    *surface_out = NULL;
+    *sx_out = 0;
+    *sy_out = 0;
+
+    // Find the output the cursor is on.
+    struct wlr_output *wlr_output = wlr_output_layout_output_at(root->output_layout, lx, ly);
+    if (wlr_output == NULL) {
+        return;
+    }
+
+    struct hwd_output *output = wlr_output->data;
+    if (!output || !output->enabled) {
+        // Output is being destroyed or is being enabled.
+        return;
+    }
+    *output_out = output;
+
+    // Pointer motion usually stays within the same surface, so check whether
+    // we can reuse the last result before walking the scene graph.
+    struct hwd_cursor *cursor = seat->cursor;
+    struct hwd_cursor_target_cache *cache = &cursor->target_cache;
+    if (cache->valid && cache->scene_generation == root->scene_generation &&
+        cache->output == output && wlr_box_contains_point(&cache->box, lx, ly)) {
+        double sx = lx - cache->surface_x;
+        double sy = ly - cache->surface_y;
+        if (wlr_surface_point_accepts_input(cache->surface, sx, sy)) {
+            *window_out = cache->window;
+            *surface_out = cache->surface;
+            *sx_out = sx;
+            *sy_out = sy;
+            return;
+        }
+    }
+
+    struct wlr_scene_node *hit =
+        scene_get_target_at(lx, ly, window_out, surface_out, sx_out, sy_out);
+
+    cursor_target_cache_update(
+        cursor, lx, ly, output, hit, *window_out, *surface_out, *sx_out, *sy_out
+    );
 }
 
 static void
@@ -300,6 +532,82 @@ cursor_unhide(struct hwd_cursor *cursor) {
     wl_event_source_timer_update(cursor->hide_source, cursor_get_timeout(cursor));
 }
 
+static bool
+cursor_should_coalesce_motion(struct hwd_cursor *cursor) {
+    if (cursor->pointer_coalesce == POINTER_COALESCE_DEFAULT) {
+        // No cached value, need to lookup in the seat_config
+        const struct seat_config *seat_config = seat_get_config(cursor->seat);
+        if (!seat_config) {
+            seat_config = seat_get_config_by_name("*");
+        }
+        if (seat_config) {
+            cursor->pointer_coalesce = seat_config->pointer_coalesce;
+        }
+        // The default is currently disabled
+        if (cursor->pointer_coalesce == POINTER_COALESCE_DEFAULT) {
+            cursor->pointer_coalesce = POINTER_COALESCE_DISABLE;
+        }
+    }
+
+    return cursor->pointer_coalesce == POINTER_COALESCE_ENABLE;
+}
+
+/**
+ * Returns the refresh interval of the output under the cursor, rounded down to
+ * the nearest millisecond.
+ */
+static int
+cursor_get_refresh_interval_msec(struct hwd_cursor *cursor) {
+    struct wlr_output *wlr_output =
+        wlr_output_layout_output_at(root->output_layout, cursor->cursor->x, cursor->cursor->y);
+
+    int refresh_mhz = 60000;
+    if (wlr_output != NULL && wlr_output->refresh > 0) {
+        refresh_mhz = wlr_output->refresh;
+    }
+
+    int interval = 1000000 / refresh_mhz;
+    return interval > 0 ? interval : 1;
+}
+
+void
+hwd_cursor_flush_motion(struct hwd_cursor *cursor) {
+    if (!cursor->motion_pending) {
+        return;
+    }
+    cursor->motion_pending = false;
+
+    uint64_t event_time = latency_event_time(cursor->motion_pending_start_msec);
+    seatop_pointer_motion(cursor->seat, cursor->motion_pending_time_msec);
+    latency_record(LATENCY_POINTER_MOTION, event_time);
+}
+
+/**
+ * Flushes pending motion from outside of a pointer event, where nothing else
+ * is going to send a pointer frame.
+ */
+static void
+cursor_flush_motion_with_frame(struct hwd_cursor *cursor) {
+    if (!cursor->motion_pending) {
+        return;
+    }
+
+    hwd_cursor_flush_motion(cursor);
+
+    // The frame sent for the original motion event only covered relative
+    // motion, so the seatop's events need a frame of their own.
+    wlr_seat_pointer_notify_frame(cursor->seat->wlr_seat);
+}
+
+static int
+handle_motion_timer(void *data) {
+    struct hwd_cursor *cursor = data;
+
+    cursor_flush_motion_with_frame(cursor);
+
+    return 0;
+}
+
 static void
 pointer_motion(
     struct hwd_cursor *cursor, uint32_t time_msec, struct wlr_input_device *device, double dx,
@@ -338,7 +646,25 @@ pointer_motion(
 
     wlr_cursor_move(cursor->cursor, device, dx, dy);
 
+    // Relative motion and the cursor image are always updated immediately.
+    // When coalescing, everything else is deferred until the next refresh of
+    // the output under the cursor and then done once with the final position.
+    if (device->type == WLR_INPUT_DEVICE_POINTER && cursor_should_coalesce_motion(cursor)) {
+        cursor->motion_pending_time_msec = time_msec;
+        if (!cursor->motion_pending) {
+            cursor->motion_pending = true;
+            cursor->motion_pending_start_msec = time_msec;
+            wl_event_source_timer_update(
+                cursor->motion_timer, cursor_get_refresh_interval_msec(cursor)
+            );
+        }
+        return;
+    }
+
+    cursor->motion_pending = false;
+    uint64_t event_time = latency_event_time(time_msec);
     seatop_pointer_motion(cursor->seat, time_msec);
+    latency_record(LATENCY_POINTER_MOTION, event_time);
 }
 
 static void
@@ -381,7 +707,9 @@ dispatch_cursor_button(
         time_msec = get_current_time_msec();
     }
 
+    uint64_t event_time = latency_event_time(time_msec);
     seatop_button(cursor->seat, time_msec, device, button, state);
+    latency_record(LATENCY_POINTER_BUTTON, event_time);
 }
 
 static void
@@ -431,6 +759,7 @@ handle_touch_down(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, touch_down);
     struct wlr_touch_down_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->touch->base);
     cursor_hide(cursor);
 
@@ -486,6 +815,7 @@ handle_touch_up(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, touch_up);
     struct wlr_touch_up_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->touch->base);
 
     struct wlr_seat *wlr_seat = cursor->seat->wlr_seat;
@@ -508,6 +838,7 @@ handle_touch_motion(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, touch_motion);
     struct wlr_touch_motion_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->touch->base);
 
     struct hwd_seat *seat = cursor->seat;
@@ -552,6 +883,8 @@ static void
 handle_touch_frame(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, touch_frame);
 
+    cursor_flush_motion_with_frame(cursor);
+
     struct wlr_seat *wlr_seat = cursor->seat->wlr_seat;
 
     if (cursor->simulating_pointer_from_touch) {
@@ -944,6 +1277,7 @@ handle_pointer_pinch_begin(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, pinch_begin);
     struct wlr_pointer_pinch_begin_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_pinch_begin(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->fingers
@@ -955,6 +1289,7 @@ handle_pointer_pinch_update(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, pinch_update);
     struct wlr_pointer_pinch_update_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_pinch_update(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->dx, event->dy,
@@ -967,6 +1302,7 @@ handle_pointer_pinch_end(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, pinch_end);
     struct wlr_pointer_pinch_end_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_pinch_end(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->cancelled
@@ -978,6 +1314,7 @@ handle_pointer_swipe_begin(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, swipe_begin);
     struct wlr_pointer_swipe_begin_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_swipe_begin(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->fingers
@@ -989,6 +1326,7 @@ handle_pointer_swipe_update(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, swipe_update);
     struct wlr_pointer_swipe_update_event *event = data;
 
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_swipe_update(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->dx, event->dy
@@ -999,6 +1337,8 @@ static void
 handle_pointer_swipe_end(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, swipe_end);
     struct wlr_pointer_swipe_end_event *event = data;
+
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_swipe_end(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->cancelled
@@ -1009,6 +1349,8 @@ static void
 handle_pointer_hold_begin(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, hold_begin);
     struct wlr_pointer_hold_begin_event *event = data;
+
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_hold_begin(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->fingers
@@ -1019,6 +1361,8 @@ static void
 handle_pointer_hold_end(struct wl_listener *listener, void *data) {
     struct hwd_cursor *cursor = wl_container_of(listener, cursor, hold_end);
     struct wlr_pointer_hold_end_event *event = data;
+
+    cursor_flush_motion_with_frame(cursor);
     cursor_handle_activity_from_device(cursor, &event->pointer->base);
     wlr_pointer_gestures_v1_send_hold_end(
         cursor->pointer_gestures, cursor->seat->wlr_seat, event->time_msec, event->cancelled
@@ -1068,7 +1412,9 @@ cursor_set_image(struct hwd_cursor *cursor, const char *image, struct wl_client
     if (!image) {
         wlr_cursor_unset_image(cursor->cursor);
     } else if (!current_image || strcmp(current_image, image) != 0) {
-        wlr_cursor_set_xcursor(cursor->cursor, cursor->xcursor_manager, image);
+        struct wlr_xcursor_manager *manager =
+            cursor->xcursor_theme ? cursor->xcursor_theme->manager : NULL;
+        wlr_cursor_set_xcursor(cursor->cursor, manager, image);
     }
 }
 
@@ -1101,6 +1447,7 @@ hwd_cursor_destroy(struct hwd_cursor *cursor) {
     }
 
     wl_event_source_remove(cursor->hide_source);
+    wl_event_source_remove(cursor->motion_timer);
 
     wl_list_remove(&cursor->image_surface_destroy.link);
     wl_list_remove(&cursor->pinch_begin.link);
@@ -1125,8 +1472,10 @@ hwd_cursor_destroy(struct hwd_cursor *cursor) {
     wl_list_remove(&cursor->tool_button.link);
     wl_list_remove(&cursor->request_set_cursor.link);
     wl_list_remove(&cursor->root_scene_changed.link);
+    wl_list_remove(&cursor->target_cache.surface_commit.link);
+    wl_list_remove(&cursor->target_cache.surface_destroy.link);
 
-    wlr_xcursor_manager_destroy(cursor->xcursor_manager);
+    cursor_theme_unref(cursor->xcursor_theme);
     wlr_cursor_destroy(cursor->cursor);
     free(cursor);
 }
@@ -1143,6 +1492,8 @@ hwd_cursor_create(struct hwd_seat *seat) {
     wlr_cursor_attach_output_layout(wlr_cursor, root->output_layout);
 
     cursor->hide_source = wl_event_loop_add_timer(server.wl_event_loop, hide_notify, cursor);
+    cursor->motion_timer =
+        wl_event_loop_add_timer(server.wl_event_loop, handle_motion_timer, cursor);
 
     wl_list_init(&cursor->image_surface_destroy.link);
     cursor->image_surface_destroy.notify = handle_image_surface_destroy;
@@ -1211,6 +1562,11 @@ hwd_cursor_create(struct hwd_seat *seat) {
     cursor->root_scene_changed.notify = handle_root_scene_changed;
     wl_signal_add(&root->events.scene_changed, &cursor->root_scene_changed);
 
+    cursor->target_cache.surface_commit.notify = handle_target_cache_surface_commit;
+    wl_list_init(&cursor->target_cache.surface_commit.link);
+    cursor->target_cache.surface_destroy.notify = handle_target_cache_surface_destroy;
+    wl_list_init(&cursor->target_cache.surface_destroy.link);
+
     wl_list_init(&cursor->constraint_commit.link);
     wl_list_init(&cursor->tablets);
     wl_list_init(&cursor->tablet_pads);
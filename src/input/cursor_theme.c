@@ -0,0 +1,209 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/input/cursor_theme.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <wayland-server-core.h>
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_xcursor_manager.h>
+#include <wlr/util/log.h>
+
+#include <hayward/profiler.h>
+#include <hayward/server.h>
+
+// Number of themes that no seat is using that are kept in the cache.
+#define CURSOR_THEME_CACHE_UNUSED_MAX 4
+
+// Cursors that hayward sets itself, rather than on behalf of a client.  See
+// `cursor_update_image` and the resize seatops.
+static const char *const cursor_theme_preload_names[] = {
+    "left_ptr",  "grab",      "col-resize", "row-resize", "n-resize",  "s-resize",
+    "e-resize",  "w-resize",  "ne-resize",  "nw-resize",  "se-resize", "sw-resize",
+};
+
+static struct wl_list cursor_themes = {&cursor_themes, &cursor_themes};
+
+static struct wl_event_source *cursor_theme_load_timer;
+
+static bool
+cursor_theme_is_named(const struct hwd_cursor_theme *theme, const char *name) {
+    return (!theme->name && !name) || (name && theme->name && strcmp(name, theme->name) == 0);
+}
+
+static void
+cursor_theme_destroy(struct hwd_cursor_theme *theme) {
+    wl_list_remove(&theme->link);
+    wlr_xcursor_manager_destroy(theme->manager);
+    free(theme->pending_scales);
+    free(theme->name);
+    free(theme);
+}
+
+static void
+cursor_theme_evict(void) {
+    int unused = 0;
+    struct hwd_cursor_theme *theme, *tmp;
+    wl_list_for_each_safe(theme, tmp, &cursor_themes, link) {
+        if (theme->refcount > 0) {
+            continue;
+        }
+        if (++unused > CURSOR_THEME_CACHE_UNUSED_MAX) {
+            wlr_log(
+                WLR_DEBUG, "Evicting cursor theme '%s' (%u) from the cache",
+                theme->name ? theme->name : "default", theme->size
+            );
+            cursor_theme_destroy(theme);
+        }
+    }
+}
+
+static void
+cursor_theme_remove_pending_scale(struct hwd_cursor_theme *theme, float scale) {
+    for (int i = 0; i < theme->pending_scales_length; i++) {
+        if (theme->pending_scales[i] == scale) {
+            theme->pending_scales_length--;
+            memmove(
+                &theme->pending_scales[i], &theme->pending_scales[i + 1],
+                sizeof(float) * (theme->pending_scales_length - i)
+            );
+            return;
+        }
+    }
+}
+
+static bool
+cursor_theme_is_loaded(struct hwd_cursor_theme *theme, float scale) {
+    struct wlr_xcursor_manager_theme *loaded;
+    wl_list_for_each(loaded, &theme->manager->scaled_themes, link) {
+        if (loaded->scale == scale) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int
+handle_load_timer(void *data) {
+    // Only load one scale of one theme at a time, so that input can be
+    // handled in between.
+    struct hwd_cursor_theme *theme;
+    wl_list_for_each(theme, &cursor_themes, link) {
+        if (theme->pending_scales_length > 0) {
+            cursor_theme_load(theme, theme->pending_scales[0]);
+            break;
+        }
+    }
+
+    wl_list_for_each(theme, &cursor_themes, link) {
+        if (theme->pending_scales_length > 0) {
+            wl_event_source_timer_update(cursor_theme_load_timer, 1);
+            break;
+        }
+    }
+
+    return 0;
+}
+
+struct hwd_cursor_theme *
+cursor_theme_get(const char *name, uint32_t size) {
+    struct hwd_cursor_theme *theme;
+    wl_list_for_each(theme, &cursor_themes, link) {
+        if (theme->size == size && cursor_theme_is_named(theme, name)) {
+            wl_list_remove(&theme->link);
+            wl_list_insert(&cursor_themes, &theme->link);
+            theme->refcount++;
+            return theme;
+        }
+    }
+
+    theme = calloc(1, sizeof(struct hwd_cursor_theme));
+    assert(theme != NULL);
+
+    if (name != NULL) {
+        theme->name = strdup(name);
+        assert(theme->name != NULL);
+    }
+    theme->size = size;
+    theme->refcount = 1;
+
+    theme->manager = wlr_xcursor_manager_create(name, size);
+    assert(theme->manager != NULL);
+
+    wl_list_insert(&cursor_themes, &theme->link);
+
+    return theme;
+}
+
+void
+cursor_theme_unref(struct hwd_cursor_theme *theme) {
+    if (theme == NULL) {
+        return;
+    }
+
+    assert(theme->refcount > 0);
+    theme->refcount--;
+    if (theme->refcount == 0) {
+        cursor_theme_evict();
+    }
+}
+
+bool
+cursor_theme_load(struct hwd_cursor_theme *theme, float scale) {
+    HWD_PROFILER_TRACE();
+
+    cursor_theme_remove_pending_scale(theme, scale);
+
+    if (cursor_theme_is_loaded(theme, scale)) {
+        return true;
+    }
+    if (!wlr_xcursor_manager_load(theme->manager, scale)) {
+        return false;
+    }
+
+    // Themes are read from disk in one go, so this is only a lookup, but it
+    // tells us up front if the theme is missing any of the cursors we use.
+    for (size_t i = 0; i < sizeof(cursor_theme_preload_names) / sizeof(char *); i++) {
+        const char *name = cursor_theme_preload_names[i];
+        if (wlr_xcursor_manager_get_xcursor(theme->manager, name, scale) == NULL) {
+            wlr_log(
+                WLR_DEBUG, "Cursor theme '%s' has no '%s' cursor",
+                theme->name ? theme->name : "default", name
+            );
+        }
+    }
+
+    return true;
+}
+
+void
+cursor_theme_queue_load(struct hwd_cursor_theme *theme, float scale) {
+    if (cursor_theme_is_loaded(theme, scale)) {
+        return;
+    }
+    for (int i = 0; i < theme->pending_scales_length; i++) {
+        if (theme->pending_scales[i] == scale) {
+            return;
+        }
+    }
+
+    theme->pending_scales =
+        realloc(theme->pending_scales, sizeof(float) * (theme->pending_scales_length + 1));
+    assert(theme->pending_scales != NULL);
+    theme->pending_scales[theme->pending_scales_length++] = scale;
+
+    if (cursor_theme_load_timer == NULL) {
+        cursor_theme_load_timer =
+            wl_event_loop_add_timer(server.wl_event_loop, handle_load_timer, NULL);
+        assert(cursor_theme_load_timer != NULL);
+    }
+    wl_event_source_timer_update(cursor_theme_load_timer, 1);
+}
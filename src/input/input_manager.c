@@ -9,6 +9,7 @@
 #include <ctype.h>
 #include <libinput.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,11 +21,13 @@
 #include <wlr/backend/libinput.h>
 #include <wlr/config.h>
 #include <wlr/types/wlr_cursor.h>
+#include <wlr/types/wlr_cursor_shape_v1.h>
 #include <wlr/types/wlr_input_device.h>
 #include <wlr/types/wlr_keyboard.h>
 #include <wlr/types/wlr_keyboard_shortcuts_inhibit_v1.h>
 #include <wlr/types/wlr_pointer.h>
 #include <wlr/types/wlr_seat.h>
+#include <wlr/types/wlr_tablet_v2.h>
 #include <wlr/types/wlr_virtual_keyboard_v1.h>
 #include <wlr/types/wlr_virtual_pointer_v1.h>
 #include <wlr/util/log.h>
@@ -34,7 +37,9 @@
 #include <hayward/input/keyboard.h>
 #include <hayward/input/libinput.h>
 #include <hayward/input/seat.h>
+#include <hayward/latency.h>
 #include <hayward/list.h>
+#include <hayward/profiler.h>
 #include <hayward/server.h>
 #include <hayward/stringop.h>
 
@@ -241,6 +246,7 @@ handle_device_destroy(struct wl_listener *listener, void *data) {
     wl_list_for_each(seat, &server.input->seats, link) { seat_remove_device(seat, input_device); }
 
     wl_list_remove(&input_device->link);
+    wl_list_remove(&input_device->pending_link);
     wl_list_remove(&input_device->device_destroy.link);
     free(input_device->identifier);
     free(input_device);
@@ -268,8 +274,15 @@ handle_new_input(struct wl_listener *listener, void *data) {
     wl_signal_add(&device->events.destroy, &input_device->device_destroy);
     input_device->device_destroy.notify = handle_device_destroy;
 
-    input_manager_verify_fallback_seat();
+    // Seats are set up once the rest of the burst has arrived.
+    wl_list_insert(input->pending_devices.prev, &input_device->pending_link);
+    input_manager_queue_device_changes();
+}
 
+static void
+input_manager_attach_device(
+    struct hwd_input_manager *input, struct hwd_input_device *input_device
+) {
     bool added = false;
     struct hwd_seat *seat = NULL;
     wl_list_for_each(seat, &input->seats, link) {
@@ -360,6 +373,7 @@ handle_virtual_keyboard(struct wl_listener *listener, void *data) {
 
     wl_signal_add(&device->events.destroy, &input_device->device_destroy);
     input_device->device_destroy.notify = handle_device_destroy;
+    wl_list_init(&input_device->pending_link);
 
     seat_add_device(seat, input_device);
 }
@@ -390,6 +404,7 @@ handle_virtual_pointer(struct wl_listener *listener, void *data) {
 
     wl_signal_add(&device->events.destroy, &input_device->device_destroy);
     input_device->device_destroy.notify = handle_device_destroy;
+    wl_list_init(&input_device->pending_link);
 
     seat_add_device(seat, input_device);
 
@@ -398,6 +413,85 @@ handle_virtual_pointer(struct wl_listener *listener, void *data) {
     }
 }
 
+static void
+handle_device_changes_idle(void *data) {
+    HWD_PROFILER_TRACE();
+
+    struct hwd_input_manager *input = data;
+
+    wlr_log(WLR_DEBUG, "Processing %d input device changes", input->num_device_changes);
+
+    if (!wl_list_empty(&input->pending_devices)) {
+        input_manager_verify_fallback_seat();
+
+        struct hwd_input_device *input_device, *tmp;
+        wl_list_for_each_safe(input_device, tmp, &input->pending_devices, pending_link) {
+            wl_list_remove(&input_device->pending_link);
+            wl_list_init(&input_device->pending_link);
+            input_manager_attach_device(input, input_device);
+        }
+    }
+
+    struct hwd_seat *seat = NULL;
+    wl_list_for_each(seat, &input->seats, link) { seat_flush_device_changes(seat); }
+
+    latency_record(LATENCY_INPUT_HOTPLUG, input->device_changes_begin);
+    input->device_changes_begin = 0;
+    input->num_device_changes = 0;
+
+    // Only cleared now, as attaching devices above queues changes that this
+    // pass has already taken care of.
+    input->device_changes_idle = NULL;
+}
+
+static void
+handle_cursor_shape_request_set_shape(struct wl_listener *listener, void *data) {
+    struct wlr_cursor_shape_manager_v1_request_set_shape_event *event = data;
+    struct hwd_seat *seat = event->seat_client->seat->data;
+
+    if (!seatop_allows_set_cursor(seat)) {
+        return;
+    }
+
+    struct wlr_surface *focused_surface = NULL;
+    switch (event->device_type) {
+    case WLR_CURSOR_SHAPE_MANAGER_V1_DEVICE_TYPE_POINTER:
+        focused_surface = seat->wlr_seat->pointer_state.focused_surface;
+        break;
+    case WLR_CURSOR_SHAPE_MANAGER_V1_DEVICE_TYPE_TABLET_TOOL:
+        focused_surface = event->tablet_tool->focused_surface;
+        break;
+    }
+
+    struct wl_client *focused_client = NULL;
+    if (focused_surface != NULL) {
+        focused_client = wl_resource_get_client(focused_surface->resource);
+    }
+
+    if (focused_client == NULL || event->seat_client->client != focused_client) {
+        wlr_log(WLR_DEBUG, "denying request to set cursor shape from unfocused client");
+        return;
+    }
+
+    // Shapes are named after the xcursor images they correspond to, so they
+    // are drawn from the seat's cached theme rather than a client buffer.
+    cursor_set_image(seat->cursor, wlr_cursor_shape_v1_name(event->shape), focused_client);
+}
+
+void
+input_manager_queue_device_changes(void) {
+    struct hwd_input_manager *input = server.input;
+
+    input->num_device_changes++;
+    if (input->device_changes_idle != NULL) {
+        return;
+    }
+
+    input->device_changes_begin = latency_now();
+    input->device_changes_idle =
+        wl_event_loop_add_idle(server.wl_event_loop, handle_device_changes_idle, input);
+}
+
 struct hwd_input_manager *
 input_manager_create(struct wl_display *wl_display, struct wlr_backend *backend) {
     struct hwd_input_manager *input = calloc(1, sizeof(struct hwd_input_manager));
@@ -407,6 +501,7 @@ input_manager_create(struct wl_display *wl_display, struct wlr_backend *backend)
 
     wl_list_init(&input->devices);
     wl_list_init(&input->seats);
+    wl_list_init(&input->pending_devices);
 
     input->new_input.notify = handle_new_input;
     wl_signal_add(&backend->events.new_input, &input->new_input);
@@ -429,25 +524,39 @@ input_manager_create(struct wl_display *wl_display, struct wlr_backend *backend)
         &input->keyboard_shortcuts_inhibit_new_inhibitor
     );
 
+    input->cursor_shape = wlr_cursor_shape_manager_v1_create(wl_display, 1);
+    input->cursor_shape_request_set_shape.notify = handle_cursor_shape_request_set_shape;
+    wl_signal_add(
+        &input->cursor_shape->events.request_set_shape, &input->cursor_shape_request_set_shape
+    );
+
     return input;
 }
 
 /**
- * Re-translate keysyms if a change in the input config could affect them.
+ * Returns the first config with xkb_layout or xkb_file, which is the one used
+ * to translate keysyms, or NULL if there isn't one.
  */
-static void
-retranslate_keysyms(struct input_config *input_config) {
+static struct input_config *
+get_keysym_translation_config(void) {
     for (int i = 0; i < config->input_configs->length; ++i) {
         struct input_config *ic = config->input_configs->items[i];
         if (ic->xkb_layout || ic->xkb_file) {
-            // this is the first config with xkb_layout or xkb_file
-            if (ic->identifier == input_config->identifier) {
-                translate_keysyms(ic);
-            }
-
-            return;
+            return ic;
         }
     }
+    return NULL;
+}
+
+/**
+ * Re-translate keysyms if a change in the input config could affect them.
+ */
+static void
+retranslate_keysyms(struct input_config *input_config) {
+    struct input_config *ic = get_keysym_translation_config();
+    if (ic != NULL && ic->identifier == input_config->identifier) {
+        translate_keysyms(ic);
+    }
 }
 
 static void
@@ -491,21 +600,81 @@ input_manager_reset_input(struct hwd_input_device *input_device) {
     wl_list_for_each(seat, &server.input->seats, link) { seat_reset_device(seat, input_device); }
 }
 
+static struct input_config *
+input_device_get_config_from(struct hwd_config *config, struct hwd_input_device *device) {
+    struct input_config *wildcard_config = NULL;
+    struct input_config *input_config = NULL;
+    for (int i = 0; i < config->input_configs->length; ++i) {
+        input_config = config->input_configs->items[i];
+        if (strcmp(input_config->identifier, device->identifier) == 0) {
+            return input_config;
+        } else if (strcmp(input_config->identifier, "*") == 0) {
+            wildcard_config = input_config;
+        }
+    }
+
+    const char *device_type = input_device_get_type(device);
+    for (int i = 0; i < config->input_type_configs->length; ++i) {
+        input_config = config->input_type_configs->items[i];
+        if (strcmp(input_config->identifier + 5, device_type) == 0) {
+            return input_config;
+        }
+    }
+
+    return wildcard_config;
+}
+
 void
-input_manager_reset_all_inputs(void) {
+input_manager_apply_reloaded_config(struct hwd_config *old_config) {
+    // Only reset and reconfigure devices whose effective config has changed,
+    // so that reloading doesn't send every client a new keymap or briefly put
+    // pointers back to their defaults.
+    bool keyboard_changed = false;
     struct hwd_input_device *input_device = NULL;
     wl_list_for_each(input_device, &server.input->devices, link) {
+        struct input_config *old_ic = input_device_get_config_from(old_config, input_device);
+        struct input_config *new_ic = input_device_get_config_from(config, input_device);
+        if (input_config_equal(old_ic, new_ic)) {
+            continue;
+        }
+
+        wlr_log(WLR_DEBUG, "Reconfiguring %s after reload", input_device->identifier);
+        if (input_device->wlr_device->type == WLR_INPUT_DEVICE_KEYBOARD) {
+            keyboard_changed = true;
+        }
         input_manager_reset_input(input_device);
+        input_manager_configure_input(input_device);
     }
 
-    // If there is at least one keyboard using the default keymap, repeat delay,
-    // and repeat rate, then it is possible that there is a keyboard group that
-    // need their keyboard disarmed.
-    struct hwd_seat *seat;
-    wl_list_for_each(seat, &server.input->seats, link) {
-        struct hwd_keyboard_group *group;
-        wl_list_for_each(group, &seat->keyboard_groups, link) {
-            hwd_keyboard_disarm_key_repeat(group->seat_device->keyboard);
+    // If a keyboard has changed then it may have left a keyboard group that
+    // needs its key repeat disarmed.
+    if (keyboard_changed) {
+        struct hwd_seat *seat;
+        wl_list_for_each(seat, &server.input->seats, link) {
+            struct hwd_keyboard_group *group;
+            wl_list_for_each(group, &seat->keyboard_groups, link) {
+                hwd_keyboard_disarm_key_repeat(group->seat_device->keyboard);
+            }
+        }
+    }
+
+    // Bindings belong to the config, but modes whose bindings are unchanged
+    // can take over the already translated and indexed bindings from the old
+    // one.
+    translate_reloaded_keysyms(old_config, get_keysym_translation_config());
+
+    // Wildcard seat configs apply to any seat without a config of its own, so
+    // if anything has been added, removed or changed then everything is
+    // re-applied.
+    bool seats_changed = config->seat_configs->length != old_config->seat_configs->length;
+    for (int i = 0; !seats_changed && i < config->seat_configs->length; ++i) {
+        struct seat_config *sc = config->seat_configs->items[i];
+        int j = list_seq_find(old_config->seat_configs, seat_name_cmp, sc->name);
+        seats_changed = j == -1 || !seat_config_equal(old_config->seat_configs->items[j], sc);
+    }
+    if (seats_changed) {
+        for (int i = 0; i < config->seat_configs->length; ++i) {
+            input_manager_apply_seat_config(config->seat_configs->items[i]);
         }
     }
 }
@@ -586,24 +755,5 @@ input_manager_configure_xcursor(void) {
 
 struct input_config *
 input_device_get_config(struct hwd_input_device *device) {
-    struct input_config *wildcard_config = NULL;
-    struct input_config *input_config = NULL;
-    for (int i = 0; i < config->input_configs->length; ++i) {
-        input_config = config->input_configs->items[i];
-        if (strcmp(input_config->identifier, device->identifier) == 0) {
-            return input_config;
-        } else if (strcmp(input_config->identifier, "*") == 0) {
-            wildcard_config = input_config;
-        }
-    }
-
-    const char *device_type = input_device_get_type(device);
-    for (int i = 0; i < config->input_type_configs->length; ++i) {
-        input_config = config->input_type_configs->items[i];
-        if (strcmp(input_config->identifier + 5, device_type) == 0) {
-            return input_config;
-        }
-    }
-
-    return wildcard_config;
+    return input_device_get_config_from(config, device);
 }
@@ -36,13 +36,18 @@
 #include <wlr/types/wlr_virtual_keyboard_v1.h>
 #include <wlr/util/log.h>
 
+#include <hayward/binding_index.h>
 #include <hayward/config.h>
+#include <hayward/globals/root.h>
 #include <hayward/input/cursor.h>
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
 #include <hayward/input/text_input.h>
+#include <hayward/latency.h>
 #include <hayward/list.h>
 #include <hayward/server.h>
+#include <hayward/tree/root.h>
+#include <hayward/tree/transaction.h>
 
 static struct modifier_key {
     char *name;
@@ -106,18 +111,161 @@ handle_xkb_context_log(
     }
 }
 
+// Compiling a keymap takes tens of milliseconds, and most setups use the same
+// one for every keyboard, so recently compiled keymaps are kept around and
+// shared between devices and across reloads.
+#define KEYMAP_CACHE_SIZE 8
+
+struct keymap_cache_entry {
+    struct xkb_keymap *keymap; // NULL if the entry is unused.
+    uint64_t last_used;
+
+    // Rule names that the keymap was compiled from.  Unset fields are NULL.
+    char *layout;
+    char *model;
+    char *options;
+    char *rules;
+    char *variant;
+
+    // Contents of the xkb file that the keymap was compiled from, or NULL if
+    // it was compiled from rule names.
+    char *file_contents;
+};
+
+static struct keymap_cache_entry keymap_cache[KEYMAP_CACHE_SIZE];
+static uint64_t keymap_cache_clock = 0;
+
+static bool
+keymap_cache_str_eq(const char *a, const char *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+static char *
+keymap_cache_strdup(const char *str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    char *copy = strdup(str);
+    assert(copy != NULL);
+    return copy;
+}
+
+static struct xkb_keymap *
+keymap_cache_lookup(const struct xkb_rule_names *rules, const char *file_contents) {
+    for (int i = 0; i < KEYMAP_CACHE_SIZE; i++) {
+        struct keymap_cache_entry *entry = &keymap_cache[i];
+        if (entry->keymap == NULL) {
+            continue;
+        }
+
+        if (file_contents != NULL) {
+            if (!keymap_cache_str_eq(entry->file_contents, file_contents)) {
+                continue;
+            }
+        } else if (entry->file_contents != NULL ||
+                   !keymap_cache_str_eq(entry->layout, rules->layout) ||
+                   !keymap_cache_str_eq(entry->model, rules->model) ||
+                   !keymap_cache_str_eq(entry->options, rules->options) ||
+                   !keymap_cache_str_eq(entry->rules, rules->rules) ||
+                   !keymap_cache_str_eq(entry->variant, rules->variant)) {
+            continue;
+        }
+
+        entry->last_used = ++keymap_cache_clock;
+        return xkb_keymap_ref(entry->keymap);
+    }
+    return NULL;
+}
+
+static void
+keymap_cache_insert(
+    const struct xkb_rule_names *rules, const char *file_contents, struct xkb_keymap *keymap
+) {
+    // Replace the least recently used entry.  Unused entries have never been
+    // used, so they are picked first.
+    struct keymap_cache_entry *entry = &keymap_cache[0];
+    for (int i = 1; i < KEYMAP_CACHE_SIZE; i++) {
+        if (keymap_cache[i].last_used < entry->last_used) {
+            entry = &keymap_cache[i];
+        }
+    }
+
+    xkb_keymap_unref(entry->keymap);
+    free(entry->layout);
+    free(entry->model);
+    free(entry->options);
+    free(entry->rules);
+    free(entry->variant);
+    free(entry->file_contents);
+    *entry = (struct keymap_cache_entry){0};
+
+    entry->keymap = xkb_keymap_ref(keymap);
+    entry->last_used = ++keymap_cache_clock;
+    if (file_contents != NULL) {
+        entry->file_contents = keymap_cache_strdup(file_contents);
+    } else {
+        entry->layout = keymap_cache_strdup(rules->layout);
+        entry->model = keymap_cache_strdup(rules->model);
+        entry->options = keymap_cache_strdup(rules->options);
+        entry->rules = keymap_cache_strdup(rules->rules);
+        entry->variant = keymap_cache_strdup(rules->variant);
+    }
+}
+
+/**
+ * Reads the whole of an xkb file, so that the keymap can be cached against
+ * its contents.  Returns NULL and sets errno on failure.
+ */
+static char *
+read_keymap_file(FILE *file) {
+    size_t length = 0;
+    size_t capacity = 4096;
+    char *contents = malloc(capacity);
+    if (!contents) {
+        return NULL;
+    }
+
+    size_t read;
+    while ((read = fread(&contents[length], 1, capacity - length - 1, file)) > 0) {
+        length += read;
+        if (length + 1 == capacity) {
+            capacity *= 2;
+            char *grown = realloc(contents, capacity);
+            if (!grown) {
+                free(contents);
+                return NULL;
+            }
+            contents = grown;
+        }
+    }
+    if (ferror(file)) {
+        free(contents);
+        errno = EIO;
+        return NULL;
+    }
+
+    contents[length] = '\0';
+    return contents;
+}
+
 struct xkb_keymap *
 hwd_keyboard_compile_keymap(struct input_config *ic, char **error) {
-    struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
-    assert(context);
-    xkb_context_set_user_data(context, error);
-    xkb_context_set_log_fn(context, handle_xkb_context_log);
-
+    struct xkb_rule_names rules = {0};
+    char *file_contents = NULL;
     struct xkb_keymap *keymap = NULL;
 
     if (ic && ic->xkb_file) {
         FILE *keymap_file = fopen(ic->xkb_file, "r");
-        if (!keymap_file) {
+        if (keymap_file) {
+            file_contents = read_keymap_file(keymap_file);
+            if (fclose(keymap_file) != 0) {
+                wlr_log_errno(WLR_ERROR, "Failed to close xkb file %s", ic->xkb_file);
+            }
+        }
+        if (!file_contents) {
             wlr_log_errno(WLR_ERROR, "cannot read xkb file %s", ic->xkb_file);
             if (error) {
                 size_t len =
@@ -132,27 +280,40 @@ hwd_keyboard_compile_keymap(struct input_config *ic, char **error) {
                     );
                 }
             }
-            goto cleanup;
+            return NULL;
         }
+    } else if (ic) {
+        input_config_fill_rule_names(ic, &rules);
+    }
 
-        keymap = xkb_keymap_new_from_file(
-            context, keymap_file, XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS
-        );
+    keymap = keymap_cache_lookup(&rules, file_contents);
+    if (keymap) {
+        free(file_contents);
+        return keymap;
+    }
 
-        if (fclose(keymap_file) != 0) {
-            wlr_log_errno(WLR_ERROR, "Failed to close xkb file %s", ic->xkb_file);
-        }
+    struct xkb_context *context = xkb_context_new(XKB_CONTEXT_NO_FLAGS);
+    assert(context);
+    xkb_context_set_user_data(context, error);
+    xkb_context_set_log_fn(context, handle_xkb_context_log);
+
+    if (file_contents) {
+        keymap = xkb_keymap_new_from_string(
+            context, file_contents, XKB_KEYMAP_FORMAT_TEXT_V1, XKB_KEYMAP_COMPILE_NO_FLAGS
+        );
     } else {
-        struct xkb_rule_names rules = {0};
-        if (ic) {
-            input_config_fill_rule_names(ic, &rules);
-        }
         keymap = xkb_keymap_new_from_names(context, &rules, XKB_KEYMAP_COMPILE_NO_FLAGS);
     }
 
-cleanup:
     xkb_context_set_user_data(context, NULL);
     xkb_context_unref(context);
+
+    // Failures aren't cached, so that errors are reported every time.
+    if (keymap) {
+        keymap_cache_insert(&rules, file_contents, keymap);
+    }
+
+    free(file_contents);
     return keymap;
 }
 
@@ -235,48 +396,68 @@ update_shortcut_state(
     return false;
 }
 
+/**
+ * Returns the index over a list of key bindings, building it if the bindings
+ * have changed since it was last used.
+ */
+static struct hwd_binding_index *
+get_binding_index(list_t *bindings, struct hwd_binding_index **index_cache) {
+    if (*index_cache != NULL) {
+        return *index_cache;
+    }
+
+    struct hwd_binding_index *index = hwd_binding_index_create();
+    for (int i = 0; i < bindings->length; ++i) {
+        struct hwd_binding *binding = bindings->items[i];
+
+        // Bindings with more keys than can be tracked can never be triggered.
+        if (binding->keys->length > HWD_KEYBOARD_PRESSED_KEYS_CAP) {
+            continue;
+        }
+        uint32_t keys[HWD_KEYBOARD_PRESSED_KEYS_CAP];
+        for (int j = 0; j < binding->keys->length; ++j) {
+            keys[j] = *(uint32_t *)binding->keys->items[j];
+        }
+
+        hwd_binding_index_add(
+            index, binding->modifiers, (binding->flags & BINDING_RELEASE) != 0, keys,
+            binding->keys->length, hwd_binding_index_intern_input(index, binding->input), binding
+        );
+    }
+
+    *index_cache = index;
+    return index;
+}
+
 /**
  * If one exists, finds a binding which matches the shortcut model state,
  * current modifiers, release state, and locked state.
  */
 static void
 get_active_binding(
-    const struct hwd_shortcut_state *state, list_t *bindings, struct hwd_binding **current_binding,
+    const struct hwd_shortcut_state *state, list_t *bindings,
+    struct hwd_binding_index **index_cache, struct hwd_binding **current_binding,
     uint32_t modifiers, bool release, bool locked, bool inhibited, const char *input,
     bool exact_input, xkb_layout_index_t group
 ) {
-    for (int i = 0; i < bindings->length; ++i) {
-        struct hwd_binding *binding = bindings->items[i];
+    struct hwd_binding_index *index = get_binding_index(bindings, index_cache);
+    int input_id = hwd_binding_index_find_input(index, input);
+
+    // Only bindings with the right modifiers, release state and keys are
+    // returned, in the same order as they appear in the mode.
+    int count = hwd_binding_index_match(
+        index, modifiers, release, state->pressed_keys, state->npressed, state->current_key
+    );
+    for (int i = 0; i < count; ++i) {
+        const struct hwd_binding_index_entry *entry = &index->entries[index->matches[i]];
+        struct hwd_binding *binding = entry->data;
         bool binding_locked = (binding->flags & BINDING_LOCKED) != 0;
         bool binding_inhibited = (binding->flags & BINDING_INHIBITED) != 0;
-        bool binding_release = binding->flags & BINDING_RELEASE;
 
-        if (modifiers ^ binding->modifiers || release != binding_release ||
-            locked > binding_locked || inhibited > binding_inhibited ||
+        if (locked > binding_locked || inhibited > binding_inhibited ||
             (binding->group != XKB_LAYOUT_INVALID && binding->group != group) ||
-            (strcmp(binding->input, input) != 0 && (strcmp(binding->input, "*") != 0 || exact_input)
-            )) {
-            continue;
-        }
-
-        bool match = false;
-        if (state->npressed == (size_t)binding->keys->length) {
-            match = true;
-            for (size_t j = 0; j < state->npressed; j++) {
-                uint32_t key = *(uint32_t *)binding->keys->items[j];
-                if (key != state->pressed_keys[j]) {
-                    match = false;
-                    break;
-                }
-            }
-        } else if (binding->keys->length == 1) {
-            /*
-             * If no multiple-key binding has matched, try looking for
-             * single-key bindings that match the newly-pressed key.
-             */
-            match = state->current_key == *(uint32_t *)binding->keys->items[0];
-        }
-        if (!match) {
+            (entry->input != input_id &&
+             (entry->input != HWD_BINDING_INDEX_INPUT_ANY || exact_input))) {
             continue;
         }
 
@@ -474,8 +655,21 @@ keyboard_get_im_grab(struct hwd_keyboard *keyboard) {
     return input_method->keyboard_grab;
 }
 
+/**
+ * Executes a binding triggered by a key event and records how long the event
+ * took to take effect.
+ */
+static void
+keyboard_execute_binding(struct hwd_seat *seat, struct hwd_binding *binding, uint64_t event_time) {
+    seat_execute_command(seat, binding);
+
+    latency_record(LATENCY_KEY_TO_BINDING, event_time);
+    hwd_transaction_manager_track_input(root_get_transaction_manager(root), event_time);
+}
+
 static void
 handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *event) {
+    uint64_t event_time = latency_event_time(event->time_msec);
     struct hwd_seat *seat = keyboard->seat_device->hwd_seat;
     struct wlr_seat *wlr_seat = seat->wlr_seat;
     struct wlr_input_device *wlr_device = keyboard->seat_device->input_device->wlr_device;
@@ -499,25 +693,28 @@ handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *e
     // Identify active release binding
     struct hwd_binding *binding_released = NULL;
     get_active_binding(
-        &keyboard->state_keycodes, config->current_mode->keycode_bindings, &binding_released,
-        keyinfo.code_modifiers, true, input_inhibited, shortcuts_inhibited, device_identifier,
-        exact_identifier, keyboard->effective_layout
+        &keyboard->state_keycodes, config->current_mode->keycode_bindings,
+        &config->current_mode->keycode_index, &binding_released, keyinfo.code_modifiers, true,
+        input_inhibited, shortcuts_inhibited, device_identifier, exact_identifier,
+        keyboard->effective_layout
     );
     get_active_binding(
-        &keyboard->state_keysyms_raw, config->current_mode->keysym_bindings, &binding_released,
-        keyinfo.raw_modifiers, true, input_inhibited, shortcuts_inhibited, device_identifier,
-        exact_identifier, keyboard->effective_layout
+        &keyboard->state_keysyms_raw, config->current_mode->keysym_bindings,
+        &config->current_mode->keysym_index, &binding_released, keyinfo.raw_modifiers, true,
+        input_inhibited, shortcuts_inhibited, device_identifier, exact_identifier,
+        keyboard->effective_layout
     );
     get_active_binding(
         &keyboard->state_keysyms_translated, config->current_mode->keysym_bindings,
-        &binding_released, keyinfo.translated_modifiers, true, input_inhibited, shortcuts_inhibited,
-        device_identifier, exact_identifier, keyboard->effective_layout
+        &config->current_mode->keysym_index, &binding_released, keyinfo.translated_modifiers,
+        true, input_inhibited, shortcuts_inhibited, device_identifier, exact_identifier,
+        keyboard->effective_layout
     );
 
     // Execute stored release binding once no longer active
     if (keyboard->held_binding && binding_released != keyboard->held_binding &&
         event->state == WL_KEYBOARD_KEY_STATE_RELEASED) {
-        seat_execute_command(seat, keyboard->held_binding);
+        keyboard_execute_binding(seat, keyboard->held_binding, event_time);
         handled = true;
     }
     if (binding_released != keyboard->held_binding) {
@@ -531,19 +728,22 @@ handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *e
     struct hwd_binding *binding = NULL;
     if (event->state == WL_KEYBOARD_KEY_STATE_PRESSED) {
         get_active_binding(
-            &keyboard->state_keycodes, config->current_mode->keycode_bindings, &binding,
-            keyinfo.code_modifiers, false, input_inhibited, shortcuts_inhibited, device_identifier,
-            exact_identifier, keyboard->effective_layout
+            &keyboard->state_keycodes, config->current_mode->keycode_bindings,
+            &config->current_mode->keycode_index, &binding, keyinfo.code_modifiers, false,
+            input_inhibited, shortcuts_inhibited, device_identifier, exact_identifier,
+            keyboard->effective_layout
         );
         get_active_binding(
-            &keyboard->state_keysyms_raw, config->current_mode->keysym_bindings, &binding,
-            keyinfo.raw_modifiers, false, input_inhibited, shortcuts_inhibited, device_identifier,
-            exact_identifier, keyboard->effective_layout
+            &keyboard->state_keysyms_raw, config->current_mode->keysym_bindings,
+            &config->current_mode->keysym_index, &binding, keyinfo.raw_modifiers, false,
+            input_inhibited, shortcuts_inhibited, device_identifier, exact_identifier,
+            keyboard->effective_layout
         );
         get_active_binding(
-            &keyboard->state_keysyms_translated, config->current_mode->keysym_bindings, &binding,
-            keyinfo.translated_modifiers, false, input_inhibited, shortcuts_inhibited,
-            device_identifier, exact_identifier, keyboard->effective_layout
+            &keyboard->state_keysyms_translated, config->current_mode->keysym_bindings,
+            &config->current_mode->keysym_index, &binding, keyinfo.translated_modifiers, false,
+            input_inhibited, shortcuts_inhibited, device_identifier, exact_identifier,
+            keyboard->effective_layout
         );
     }
 
@@ -561,7 +761,7 @@ handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *e
     }
 
     if (binding) {
-        seat_execute_command(seat, binding);
+        keyboard_execute_binding(seat, binding, event_time);
         handled = true;
     }
 
@@ -593,6 +793,7 @@ handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *e
         if (pressed_sent) {
             wlr_seat_set_keyboard(wlr_seat, keyboard->wlr);
             wlr_seat_keyboard_notify_key(wlr_seat, event->time_msec, event->keycode, event->state);
+            latency_record(LATENCY_KEY_TO_CLIENT, event_time);
             handled = true;
         }
     }
@@ -605,6 +806,7 @@ handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *e
             wlr_input_method_keyboard_grab_v2_send_key(
                 kb_grab, event->time_msec, event->keycode, event->state
             );
+            latency_record(LATENCY_KEY_TO_CLIENT, event_time);
             handled = true;
         }
     }
@@ -617,6 +819,7 @@ handle_key_event(struct hwd_keyboard *keyboard, struct wlr_keyboard_key_event *e
         );
         wlr_seat_set_keyboard(wlr_seat, keyboard->wlr);
         wlr_seat_keyboard_notify_key(wlr_seat, event->time_msec, event->keycode, event->state);
+        latency_record(LATENCY_KEY_TO_CLIENT, event_time);
     }
 
     free(device_identifier);
@@ -943,8 +1146,14 @@ hwd_keyboard_configure(struct hwd_keyboard *keyboard) {
         }
     }
 
-    bool keymap_changed =
-        keyboard->keymap ? !wlr_keyboard_keymaps_match(keyboard->keymap, keymap) : true;
+    // Keymaps are shared through the cache, so an unchanged keymap is usually
+    // the same object, and can be detected without comparing serializations.
+    bool keymap_changed = true;
+    if (keyboard->keymap == keymap) {
+        keymap_changed = false;
+    } else if (keyboard->keymap) {
+        keymap_changed = !wlr_keyboard_keymaps_match(keyboard->keymap, keymap);
+    }
 
     int repeat_rate = 25;
     if (input_config && input_config->repeat_rate != INT_MIN) {
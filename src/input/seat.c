@@ -43,6 +43,7 @@
 #include <hayward/desktop/xwayland.h>
 #include <hayward/globals/root.h>
 #include <hayward/input/cursor.h>
+#include <hayward/input/cursor_theme.h>
 #include <hayward/input/input_manager.h>
 #include <hayward/input/keyboard.h>
 #include <hayward/input/libinput.h>
@@ -398,10 +399,14 @@ handle_root_focus_changed(struct wl_listener *listener, void *data) {
     seat_commit_focus(seat);
 }
 
-static void
-seat_update_capabilities(struct hwd_seat *seat) {
+/**
+ * Returns the capabilities that the seat's attached devices provide.  These
+ * can be ahead of the capabilities advertised by the `wlr_seat`, which are
+ * only updated when device changes are flushed.
+ */
+static uint32_t
+seat_get_device_capabilities(struct hwd_seat *seat) {
     uint32_t caps = 0;
-    uint32_t previous_caps = seat->wlr_seat->capabilities;
     struct hwd_seat_device *seat_device;
     wl_list_for_each(seat_device, &seat->devices, link) {
         switch (seat_device->input_device->wlr_device->type) {
@@ -422,6 +427,13 @@ seat_update_capabilities(struct hwd_seat *seat) {
             break;
         }
     }
+    return caps;
+}
+
+static void
+seat_update_capabilities(struct hwd_seat *seat) {
+    uint32_t caps = seat_get_device_capabilities(seat);
+    uint32_t previous_caps = seat->wlr_seat->capabilities;
 
     // Hide cursor if seat doesn't have pointer capability.
     // We must call cursor_set_image while the wlr_seat has the capabilities
@@ -578,7 +590,7 @@ seat_apply_input_config(struct hwd_seat *seat, struct hwd_seat_device *hwd_devic
 static void
 seat_configure_pointer(struct hwd_seat *seat, struct hwd_seat_device *hwd_device) {
     if ((seat->wlr_seat->capabilities & WL_SEAT_CAPABILITY_POINTER) == 0) {
-        seat_configure_xcursor(seat);
+        seat_queue_configure_xcursor(seat);
     }
     wlr_cursor_attach_input_device(seat->cursor->cursor, hwd_device->input_device->wlr_device);
     seat_apply_input_config(seat, hwd_device);
@@ -738,7 +750,8 @@ seat_add_device(struct hwd_seat *seat, struct hwd_input_device *input_device) {
 
     seat_configure_device(seat, input_device);
 
-    seat_update_capabilities(seat);
+    seat->capabilities_dirty = true;
+    input_manager_queue_device_changes();
 }
 
 void
@@ -755,16 +768,14 @@ seat_remove_device(struct hwd_seat *seat, struct hwd_input_device *input_device)
 
     seat_device_destroy(seat_device);
 
-    seat_update_capabilities(seat);
-}
-
-static bool
-xcursor_manager_is_named(const struct wlr_xcursor_manager *manager, const char *name) {
-    return (!manager->name && !name) || (name && manager->name && strcmp(name, manager->name) == 0);
+    seat->capabilities_dirty = true;
+    input_manager_queue_device_changes();
 }
 
 void
 seat_configure_xcursor(struct hwd_seat *seat) {
+    seat->xcursor_dirty = false;
+
     unsigned cursor_size = 24;
     const char *cursor_theme = NULL;
 
@@ -786,49 +797,47 @@ seat_configure_xcursor(struct hwd_seat *seat) {
         }
 
 #if HAVE_XWAYLAND
-        if (server.xwayland != NULL &&
-            (!server.xwayland->xcursor_manager ||
-             !xcursor_manager_is_named(server.xwayland->xcursor_manager, cursor_theme) ||
-             server.xwayland->xcursor_manager->size != cursor_size)) {
-
-            wlr_xcursor_manager_destroy(server.xwayland->xcursor_manager);
-
-            server.xwayland->xcursor_manager =
-                wlr_xcursor_manager_create(cursor_theme, cursor_size);
-            assert(server.xwayland->xcursor_manager);
-
-            wlr_xcursor_manager_load(server.xwayland->xcursor_manager, 1);
-            struct wlr_xcursor *xcursor =
-                wlr_xcursor_manager_get_xcursor(server.xwayland->xcursor_manager, "left_ptr", 1);
-            if (xcursor != NULL) {
-                struct wlr_xcursor_image *image = xcursor->images[0];
-                wlr_xwayland_set_cursor(
-                    server.xwayland->xwayland, image->buffer, image->width * 4, image->width,
-                    image->height, image->hotspot_x, image->hotspot_y
-                );
+        if (server.xwayland != NULL) {
+            struct hwd_cursor_theme *theme = cursor_theme_get(cursor_theme, cursor_size);
+            if (theme == server.xwayland->xcursor_theme) {
+                cursor_theme_unref(theme);
+            } else {
+                cursor_theme_unref(server.xwayland->xcursor_theme);
+                server.xwayland->xcursor_theme = theme;
+
+                cursor_theme_load(theme, 1);
+                struct wlr_xcursor *xcursor =
+                    wlr_xcursor_manager_get_xcursor(theme->manager, "left_ptr", 1);
+                if (xcursor != NULL) {
+                    struct wlr_xcursor_image *image = xcursor->images[0];
+                    wlr_xwayland_set_cursor(
+                        server.xwayland->xwayland, image->buffer, image->width * 4, image->width,
+                        image->height, image->hotspot_x, image->hotspot_y
+                    );
+                }
             }
         }
 #endif
     }
 
-    /* Create xcursor manager if we don't have one already, or if the
-     * theme has changed */
-    if (!seat->cursor->xcursor_manager ||
-        !xcursor_manager_is_named(seat->cursor->xcursor_manager, cursor_theme) ||
-        seat->cursor->xcursor_manager->size != cursor_size) {
-
-        wlr_xcursor_manager_destroy(seat->cursor->xcursor_manager);
-        seat->cursor->xcursor_manager = wlr_xcursor_manager_create(cursor_theme, cursor_size);
-        if (!seat->cursor->xcursor_manager) {
-            wlr_log(WLR_ERROR, "Cannot create XCursor manager for theme '%s'", cursor_theme);
-        }
-    }
+    // Themes are shared with other seats, and with previous configs, so this
+    // only reads the theme from disk if nothing has used it recently.
+    struct hwd_cursor_theme *theme = cursor_theme_get(cursor_theme, cursor_size);
+    cursor_theme_unref(seat->cursor->xcursor_theme);
+    seat->cursor->xcursor_theme = theme;
 
+    // Seats without a pointer don't show a cursor, so there is no need to
+    // hold up the event loop loading the theme for them.  This is the case
+    // for every seat when outputs are first enabled, before any input devices
+    // have been attached.  This is decided from the attached devices, as the
+    // `wlr_seat` capabilities are only updated after the theme is loaded.
+    bool has_pointer = seat_get_device_capabilities(seat) & WL_SEAT_CAPABILITY_POINTER;
     for (int i = 0; i < root->outputs->length; ++i) {
         struct hwd_output *hwd_output = root->outputs->items[i];
         struct wlr_output *output = hwd_output->wlr_output;
-        bool result = wlr_xcursor_manager_load(seat->cursor->xcursor_manager, output->scale);
-        if (!result) {
+        if (!has_pointer) {
+            cursor_theme_queue_load(theme, output->scale);
+        } else if (!cursor_theme_load(theme, output->scale)) {
             wlr_log(
                 WLR_ERROR, "Cannot load xcursor theme for output '%s' with scale %f", output->name,
                 output->scale
@@ -842,6 +851,25 @@ seat_configure_xcursor(struct hwd_seat *seat) {
     wlr_cursor_warp(seat->cursor->cursor, NULL, seat->cursor->cursor->x, seat->cursor->cursor->y);
 }
 
+void
+seat_queue_configure_xcursor(struct hwd_seat *seat) {
+    seat->xcursor_dirty = true;
+    input_manager_queue_device_changes();
+}
+
+void
+seat_flush_device_changes(struct hwd_seat *seat) {
+    // The cursor theme has to be loaded before the capabilities are updated,
+    // so that gaining a pointer can set the default cursor image.
+    if (seat->xcursor_dirty) {
+        seat_configure_xcursor(seat);
+    }
+    if (seat->capabilities_dirty) {
+        seat->capabilities_dirty = false;
+        seat_update_capabilities(seat);
+    }
+}
+
 static void
 seat_send_focus(struct hwd_seat *seat, struct wlr_surface *surface) {
     if (!seat_is_input_allowed(seat, surface)) {
@@ -995,6 +1023,8 @@ seatop_button(
     struct hwd_seat *seat, uint32_t time_msec, struct wlr_input_device *device, uint32_t button,
     enum wl_pointer_button_state state
 ) {
+    hwd_cursor_flush_motion(seat->cursor);
+
     if (seat->seatop_impl->button) {
         seat->seatop_impl->button(seat, time_msec, device, button, state);
     }
@@ -1009,6 +1039,8 @@ seatop_pointer_motion(struct hwd_seat *seat, uint32_t time_msec) {
 
 void
 seatop_pointer_axis(struct hwd_seat *seat, struct wlr_pointer_axis_event *event) {
+    hwd_cursor_flush_motion(seat->cursor);
+
     if (seat->seatop_impl->pointer_axis) {
         seat->seatop_impl->pointer_axis(seat, event);
     }
@@ -1019,6 +1051,8 @@ seatop_tablet_tool_tip(
     struct hwd_seat *seat, struct hwd_tablet_tool *tool, uint32_t time_msec,
     enum wlr_tablet_tool_tip_state state
 ) {
+    hwd_cursor_flush_motion(seat->cursor);
+
     if (seat->seatop_impl->tablet_tool_tip) {
         seat->seatop_impl->tablet_tool_tip(seat, tool, time_msec, state);
     }
@@ -1026,6 +1060,8 @@ seatop_tablet_tool_tip(
 
 void
 seatop_tablet_tool_motion(struct hwd_seat *seat, struct hwd_tablet_tool *tool, uint32_t time_msec) {
+    hwd_cursor_flush_motion(seat->cursor);
+
     if (seat->seatop_impl->tablet_tool_motion) {
         seat->seatop_impl->tablet_tool_motion(seat, tool, time_msec);
     } else {
@@ -1035,6 +1071,8 @@ seatop_tablet_tool_motion(struct hwd_seat *seat, struct hwd_tablet_tool *tool, u
 
 void
 seatop_rebase(struct hwd_seat *seat, uint32_t time_msec) {
+    hwd_cursor_flush_motion(seat->cursor);
+
     if (seat->seatop_impl->rebase) {
         seat->seatop_impl->rebase(seat, time_msec);
     }
@@ -16,6 +16,7 @@
 #include <wlr/types/wlr_switch.h>
 #include <wlr/util/log.h>
 
+#include <hayward/commands.h>
 #include <hayward/config.h>
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
@@ -88,6 +89,10 @@ execute_binding(struct hwd_switch *hwd_switch) {
         dummy_binding->command = matched_binding->command;
 
         seat_execute_command(seat, dummy_binding);
+
+        // Switches toggle rarely, and the command may have unbound the
+        // matched binding, so don't try to keep the compiled command.
+        cmd_compiled_unref(dummy_binding->compiled);
         free(dummy_binding);
     }
 }
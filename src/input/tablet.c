@@ -77,7 +77,7 @@ hwd_configure_tablet(struct hwd_tablet *tablet) {
     struct hwd_seat *seat = tablet->seat_device->hwd_seat;
 
     if ((seat->wlr_seat->capabilities & WL_SEAT_CAPABILITY_POINTER) == 0) {
-        seat_configure_xcursor(seat);
+        seat_queue_configure_xcursor(seat);
     }
 
     if (!tablet->tablet_v2) {
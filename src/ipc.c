@@ -0,0 +1,903 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/ipc.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <json.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <wayland-server-core.h>
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_output.h>
+#include <wlr/util/log.h>
+
+#include <hayward/commands.h>
+#include <hayward/config.h>
+#include <hayward/globals/root.h>
+#include <hayward/list.h>
+#include <hayward/profiler.h>
+#include <hayward/snapshot.h>
+#include <hayward/tree/column.h>
+#include <hayward/tree/output.h>
+#include <hayward/tree/root.h>
+#include <hayward/tree/transaction.h>
+#include <hayward/tree/window.h>
+#include <hayward/tree/workspace.h>
+
+// Requests larger than this are assumed to be garbage, and the client is
+// disconnected.
+#define IPC_MAX_PAYLOAD_LENGTH (1024 * 1024)
+
+// Clients that let this much output build up without reading it are
+// disconnected, rather than letting them use an unbounded amount of memory.
+#define IPC_MAX_WRITE_BACKLOG (4 * 1024 * 1024)
+
+// Batches hold back every transaction, not just the ones made by the client,
+// so don't let one client stall the display for longer than this.
+#define IPC_BATCH_TIMEOUT_MS 1000
+
+static const char *ipc_event_names[HWD_IPC_EVENT_COUNT] = {
+    [HWD_IPC_EVENT_WORKSPACE] = "workspace",
+    [HWD_IPC_EVENT_OUTPUT] = "output",
+    [HWD_IPC_EVENT_MODE] = "mode",
+    [HWD_IPC_EVENT_WINDOW] = "window",
+    [HWD_IPC_EVENT_FOCUS] = "focus",
+};
+
+static bool
+ipc_set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFD);
+    if (flags == -1 || fcntl(fd, F_SETFD, flags | FD_CLOEXEC) == -1) {
+        return false;
+    }
+    flags = fcntl(fd, F_GETFL);
+    if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        return false;
+    }
+    return true;
+}
+
+static char *
+ipc_json_to_string(struct json_object *object) {
+    char *string = strdup(json_object_to_json_string_ext(object, JSON_C_TO_STRING_PLAIN));
+    assert(string != NULL);
+    json_object_put(object);
+    return string;
+}
+
+static struct json_object *
+ipc_json_rect(double x, double y, double width, double height) {
+    struct json_object *rect = json_object_new_object();
+    json_object_object_add(rect, "x", json_object_new_int((int)x));
+    json_object_object_add(rect, "y", json_object_new_int((int)y));
+    json_object_object_add(rect, "width", json_object_new_int((int)width));
+    json_object_object_add(rect, "height", json_object_new_int((int)height));
+    return rect;
+}
+
+static struct json_object *
+ipc_describe_workspaces(void) {
+    struct json_object *array = json_object_new_array();
+    for (int i = 0; i < root->workspaces->length; i++) {
+        struct hwd_workspace *workspace = root->workspaces->items[i];
+        if (workspace->current.dead) {
+            continue;
+        }
+
+        struct json_object *object = json_object_new_object();
+        json_object_object_add(object, "id", json_object_new_int64(workspace->id));
+        json_object_object_add(object, "name", json_object_new_string(workspace->name));
+        json_object_object_add(
+            object, "active", json_object_new_boolean(workspace == root->current.workspace)
+        );
+        json_object_object_add(
+            object, "focused", json_object_new_boolean(workspace->current.focused)
+        );
+        json_object_object_add(object, "urgent", json_object_new_boolean(workspace->urgent));
+        json_object_array_add(array, object);
+    }
+    return array;
+}
+
+static struct json_object *
+ipc_describe_outputs(void) {
+    struct json_object *array = json_object_new_array();
+    struct hwd_output *output;
+    wl_list_for_each(output, &root->all_outputs, link) {
+        if (output->current.dead) {
+            continue;
+        }
+
+        struct json_object *object = json_object_new_object();
+        json_object_object_add(object, "id", json_object_new_int64(output->id));
+        json_object_object_add(object, "name", json_object_new_string(output->wlr_output->name));
+        json_object_object_add(
+            object, "enabled", json_object_new_boolean(!output->current.disabled)
+        );
+        json_object_object_add(
+            object, "rect",
+            ipc_json_rect(
+                output->current.x, output->current.y, output->current.width,
+                output->current.height
+            )
+        );
+        json_object_object_add(object, "scale", json_object_new_double(output->wlr_output->scale));
+        json_object_array_add(array, object);
+    }
+    return array;
+}
+
+static struct json_object *
+ipc_describe_window(struct hwd_window *window, struct hwd_workspace *workspace, bool floating) {
+    struct json_object *object = json_object_new_object();
+    json_object_object_add(object, "id", json_object_new_int64(window->id));
+    json_object_object_add(
+        object, "title", window->title ? json_object_new_string(window->title) : NULL
+    );
+    json_object_object_add(object, "workspace", json_object_new_string(workspace->name));
+    json_object_object_add(object, "floating", json_object_new_boolean(floating));
+    json_object_object_add(object, "focused", json_object_new_boolean(window->current.focused));
+    json_object_object_add(
+        object, "fullscreen", json_object_new_boolean(window->current.fullscreen)
+    );
+    json_object_object_add(object, "urgent", json_object_new_boolean(window->is_urgent));
+    json_object_object_add(
+        object, "rect",
+        ipc_json_rect(
+            window->current.x, window->current.y, window->current.width, window->current.height
+        )
+    );
+    return object;
+}
+
+static struct json_object *
+ipc_describe_windows(void) {
+    struct json_object *array = json_object_new_array();
+    for (int i = 0; i < root->workspaces->length; i++) {
+        struct hwd_workspace *workspace = root->workspaces->items[i];
+        if (workspace->current.dead) {
+            continue;
+        }
+
+        for (int j = 0; j < workspace->current.columns->length; j++) {
+            struct hwd_column *column = workspace->current.columns->items[j];
+            for (int k = 0; k < column->current.children->length; k++) {
+                struct hwd_window *window = column->current.children->items[k];
+                json_object_array_add(array, ipc_describe_window(window, workspace, false));
+            }
+        }
+        for (int j = 0; j < workspace->current.floating->length; j++) {
+            struct hwd_window *window = workspace->current.floating->items[j];
+            json_object_array_add(array, ipc_describe_window(window, workspace, true));
+        }
+    }
+    return array;
+}
+
+static struct hwd_window *
+ipc_find_focused_window(struct hwd_workspace *workspace) {
+    for (int i = 0; i < workspace->current.columns->length; i++) {
+        struct hwd_column *column = workspace->current.columns->items[i];
+        for (int j = 0; j < column->current.children->length; j++) {
+            struct hwd_window *window = column->current.children->items[j];
+            if (window->current.focused) {
+                return window;
+            }
+        }
+    }
+    for (int i = 0; i < workspace->current.floating->length; i++) {
+        struct hwd_window *window = workspace->current.floating->items[i];
+        if (window->current.focused) {
+            return window;
+        }
+    }
+    return NULL;
+}
+
+static struct json_object *
+ipc_describe_focus(void) {
+    struct hwd_workspace *workspace = root->current.workspace;
+    struct hwd_window *window = NULL;
+    if (workspace != NULL && workspace->current.focused) {
+        window = ipc_find_focused_window(workspace);
+    }
+
+    struct json_object *object = json_object_new_object();
+    json_object_object_add(
+        object, "workspace", workspace ? json_object_new_string(workspace->name) : NULL
+    );
+    json_object_object_add(object, "window", window ? json_object_new_int64(window->id) : NULL);
+    return object;
+}
+
+static struct json_object *
+ipc_describe_mode(void) {
+    struct json_object *object = json_object_new_object();
+    json_object_object_add(object, "name", json_object_new_string(config->current_mode->name));
+    json_object_object_add(object, "pango", json_object_new_boolean(config->current_mode->pango));
+    return object;
+}
+
+static struct json_object *
+ipc_describe(enum hwd_ipc_event event) {
+    switch (event) {
+    case HWD_IPC_EVENT_WORKSPACE:
+        return ipc_describe_workspaces();
+    case HWD_IPC_EVENT_OUTPUT:
+        return ipc_describe_outputs();
+    case HWD_IPC_EVENT_MODE:
+        return ipc_describe_mode();
+    case HWD_IPC_EVENT_WINDOW:
+        return ipc_describe_windows();
+    case HWD_IPC_EVENT_FOCUS:
+        return ipc_describe_focus();
+    case HWD_IPC_EVENT_COUNT:
+        break;
+    }
+    abort();
+}
+
+static void
+ipc_client_end_batches(struct hwd_ipc_client *client) {
+    while (client->batch_depth > 0) {
+        hwd_transaction_manager_end_batch(client->server->transaction_manager);
+        client->batch_depth--;
+    }
+    if (client->batch_timer != NULL) {
+        wl_event_source_remove(client->batch_timer);
+        client->batch_timer = NULL;
+    }
+}
+
+static int
+handle_batch_timeout(void *data) {
+    struct hwd_ipc_client *client = data;
+
+    wlr_log(WLR_INFO, "IPC client %d held a batch for too long, ending it", client->fd);
+    ipc_client_end_batches(client);
+
+    return 0;
+}
+
+static void
+ipc_client_destroy(struct hwd_ipc_client *client) {
+    wlr_log(WLR_DEBUG, "IPC client %d disconnected", client->fd);
+
+    ipc_client_end_batches(client);
+    wl_list_remove(&client->link);
+    wl_event_source_remove(client->event_source);
+    close(client->fd);
+    free(client->payload);
+    free(client->write_buffer);
+    free(client);
+}
+
+static bool
+ipc_client_queue(
+    struct hwd_ipc_client *client, uint32_t type, const char *payload, size_t payload_length
+) {
+    // Drop whatever has already been written before growing the buffer.
+    if (client->write_offset > 0) {
+        client->write_length -= client->write_offset;
+        if (client->send_fd != -1) {
+            client->send_fd_offset -= client->write_offset;
+        }
+        memmove(
+            client->write_buffer, client->write_buffer + client->write_offset,
+            client->write_length
+        );
+        client->write_offset = 0;
+    }
+
+    size_t length = client->write_length + HWD_IPC_HEADER_LENGTH + payload_length;
+    if (length > IPC_MAX_WRITE_BACKLOG) {
+        wlr_log(WLR_INFO, "IPC client %d is not reading its replies", client->fd);
+        return false;
+    }
+    if (length > client->write_capacity) {
+        size_t capacity = client->write_capacity ? client->write_capacity : 4096;
+        while (capacity < length) {
+            capacity *= 2;
+        }
+        client->write_buffer = realloc(client->write_buffer, capacity);
+        assert(client->write_buffer != NULL);
+        client->write_capacity = capacity;
+    }
+
+    uint32_t header_length = payload_length;
+    char *header = client->write_buffer + client->write_length;
+    memcpy(header, HWD_IPC_MAGIC, HWD_IPC_MAGIC_LENGTH);
+    memcpy(header + HWD_IPC_MAGIC_LENGTH, &header_length, sizeof(uint32_t));
+    memcpy(header + HWD_IPC_MAGIC_LENGTH + sizeof(uint32_t), &type, sizeof(uint32_t));
+    memcpy(header + HWD_IPC_HEADER_LENGTH, payload, payload_length);
+    client->write_length = length;
+
+    return true;
+}
+
+static ssize_t
+ipc_client_write(struct hwd_ipc_client *client) {
+    char *buffer = client->write_buffer + client->write_offset;
+    size_t length = client->write_length - client->write_offset;
+
+    if (client->send_fd == -1) {
+        return write(client->fd, buffer, length);
+    }
+    if (client->write_offset < client->send_fd_offset) {
+        // Stop short of the message that the file descriptor belongs to.
+        return write(client->fd, buffer, client->send_fd_offset - client->write_offset);
+    }
+
+    char control[CMSG_SPACE(sizeof(int))] = {0};
+    struct iovec iov = {.iov_base = buffer, .iov_len = length};
+    struct msghdr message = {
+        .msg_iov = &iov,
+        .msg_iovlen = 1,
+        .msg_control = control,
+        .msg_controllen = sizeof(control),
+    };
+    struct cmsghdr *cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    memcpy(CMSG_DATA(cmsg), &client->send_fd, sizeof(int));
+
+    ssize_t written = sendmsg(client->fd, &message, 0);
+    if (written > 0) {
+        client->send_fd = -1;
+    }
+    return written;
+}
+
+/**
+ * Writes as much of the write buffer as the socket will take.  Events are only
+ * queued once everything before them has been written, so that a client that
+ * is slow to read gets the latest state of each category when it catches up
+ * rather than every state in between.  Returns false if the client should be
+ * disconnected.
+ */
+static bool
+ipc_client_flush(struct hwd_ipc_client *client) {
+    struct hwd_ipc_server *server = client->server;
+
+    while (true) {
+        while (client->write_offset < client->write_length) {
+            ssize_t written = ipc_client_write(client);
+            if (written == -1 && errno == EINTR) {
+                continue;
+            }
+            if (written == -1 && errno == EAGAIN) {
+                wl_event_source_fd_update(
+                    client->event_source, WL_EVENT_READABLE | WL_EVENT_WRITABLE
+                );
+                return true;
+            }
+            if (written == -1) {
+                return false;
+            }
+            client->write_offset += written;
+        }
+        client->write_offset = 0;
+        client->write_length = 0;
+
+        if (client->pending_events == 0) {
+            break;
+        }
+        for (int i = 0; i < HWD_IPC_EVENT_COUNT; i++) {
+            if (!(client->pending_events & (1u << i))) {
+                continue;
+            }
+            const char *payload = server->last_events[i];
+            if (payload == NULL) {
+                continue;
+            }
+            if (!ipc_client_queue(client, HWD_IPC_EVENT_FLAG | i, payload, strlen(payload))) {
+                return false;
+            }
+        }
+        client->pending_events = 0;
+    }
+
+    wl_event_source_fd_update(client->event_source, WL_EVENT_READABLE);
+    return true;
+}
+
+static bool
+ipc_client_reply(struct hwd_ipc_client *client, uint32_t type, struct json_object *object) {
+    const char *payload = json_object_to_json_string_ext(object, JSON_C_TO_STRING_PLAIN);
+    bool ok = ipc_client_queue(client, type, payload, strlen(payload));
+    json_object_put(object);
+    return ok;
+}
+
+static struct json_object *
+ipc_status(bool success, const char *error) {
+    struct json_object *object = json_object_new_object();
+    json_object_object_add(object, "success", json_object_new_boolean(success));
+    if (error != NULL) {
+        json_object_object_add(object, "error", json_object_new_string(error));
+    }
+    return object;
+}
+
+static struct json_object *
+ipc_run_command(char *command) {
+    wlr_log(WLR_INFO, "IPC client ran command: %s", command);
+
+    struct json_object *array = json_object_new_array();
+    list_t *res_list = execute_command(command, NULL, NULL);
+    if (res_list == NULL) {
+        json_object_array_add(array, ipc_status(false, "Unable to run command"));
+        return array;
+    }
+    for (int i = 0; i < res_list->length; i++) {
+        struct cmd_results *results = res_list->items[i];
+        json_object_array_add(array, ipc_status(results->status == CMD_SUCCESS, results->error));
+        free_cmd_results(results);
+    }
+    list_free(res_list);
+    return array;
+}
+
+static struct json_object *
+ipc_subscribe(struct hwd_ipc_client *client, const char *payload) {
+    struct json_object *request = json_tokener_parse(payload);
+    if (request == NULL || !json_object_is_type(request, json_type_array)) {
+        json_object_put(request);
+        return ipc_status(false, "Expected an array of event names");
+    }
+
+    uint32_t subscriptions = 0;
+    for (size_t i = 0; i < json_object_array_length(request); i++) {
+        const char *name = json_object_get_string(json_object_array_get_idx(request, i));
+        int event = 0;
+        while (event < HWD_IPC_EVENT_COUNT &&
+               (name == NULL || strcmp(name, ipc_event_names[event]) != 0)) {
+            event++;
+        }
+        if (event == HWD_IPC_EVENT_COUNT) {
+            json_object_put(request);
+            return ipc_status(false, "Unknown event");
+        }
+        subscriptions |= 1u << event;
+    }
+    json_object_put(request);
+
+    // Events are only generated for categories that someone is subscribed to,
+    // so make sure there is something to compare the next state with.
+    struct hwd_ipc_server *server = client->server;
+    for (int i = 0; i < HWD_IPC_EVENT_COUNT; i++) {
+        if ((subscriptions & (1u << i)) && server->last_events[i] == NULL) {
+            server->last_events[i] = ipc_json_to_string(ipc_describe(i));
+        }
+    }
+    client->subscriptions |= subscriptions;
+
+    return ipc_status(true, NULL);
+}
+
+static struct json_object *
+ipc_get_snapshot(struct hwd_ipc_client *client) {
+    struct hwd_ipc_server *server = client->server;
+
+    if (client->send_fd != -1) {
+        return ipc_status(false, "A snapshot is already being sent");
+    }
+    if (server->snapshot == NULL) {
+        server->snapshot = snapshot_create(server->transaction_manager);
+    }
+    if (server->snapshot == NULL) {
+        return ipc_status(false, "Unable to create layout snapshot");
+    }
+
+    client->send_fd = snapshot_get_fd(server->snapshot);
+    client->send_fd_offset = client->write_length;
+
+    struct json_object *reply = ipc_status(true, NULL);
+    json_object_object_add(reply, "version", json_object_new_int(HWD_SNAPSHOT_VERSION));
+    return reply;
+}
+
+static struct json_object *
+ipc_begin_batch(struct hwd_ipc_client *client) {
+    struct hwd_ipc_server *server = client->server;
+
+    if (client->batch_depth == 0) {
+        client->batch_timer =
+            wl_event_loop_add_timer(server->event_loop, handle_batch_timeout, client);
+        assert(client->batch_timer != NULL);
+        wl_event_source_timer_update(client->batch_timer, IPC_BATCH_TIMEOUT_MS);
+    }
+    client->batch_depth++;
+    hwd_transaction_manager_begin_batch(server->transaction_manager);
+
+    return ipc_status(true, NULL);
+}
+
+static struct json_object *
+ipc_end_batch(struct hwd_ipc_client *client) {
+    if (client->batch_depth == 0) {
+        return ipc_status(false, "No batch to end");
+    }
+    client->batch_depth--;
+    hwd_transaction_manager_end_batch(client->server->transaction_manager);
+    if (client->batch_depth == 0) {
+        wl_event_source_remove(client->batch_timer);
+        client->batch_timer = NULL;
+    }
+
+    return ipc_status(true, NULL);
+}
+
+static bool
+ipc_client_handle_message(struct hwd_ipc_client *client) {
+    HWD_PROFILER_TRACE();
+
+    char *payload = client->payload;
+    struct json_object *reply;
+
+    switch (client->payload_type) {
+    case HWD_IPC_COMMAND:
+        reply = ipc_run_command(payload);
+        break;
+    case HWD_IPC_GET_WORKSPACES:
+        reply = ipc_describe_workspaces();
+        break;
+    case HWD_IPC_SUBSCRIBE:
+        reply = ipc_subscribe(client, payload);
+        break;
+    case HWD_IPC_GET_OUTPUTS:
+        reply = ipc_describe_outputs();
+        break;
+    case HWD_IPC_GET_WINDOWS:
+        reply = ipc_describe_windows();
+        break;
+    case HWD_IPC_GET_FOCUS:
+        reply = ipc_describe_focus();
+        break;
+    case HWD_IPC_GET_MODE:
+        reply = ipc_describe_mode();
+        break;
+    case HWD_IPC_GET_VERSION:
+        reply = json_object_new_object();
+        json_object_object_add(reply, "version", json_object_new_string(HWD_VERSION));
+        break;
+    case HWD_IPC_GET_SNAPSHOT:
+        reply = ipc_get_snapshot(client);
+        break;
+    case HWD_IPC_BATCH_BEGIN:
+        reply = ipc_begin_batch(client);
+        break;
+    case HWD_IPC_BATCH_END:
+        reply = ipc_end_batch(client);
+        break;
+    default:
+        wlr_log(WLR_INFO, "IPC client sent unknown message type %u", client->payload_type);
+        return false;
+    }
+
+    return ipc_client_reply(client, client->payload_type, reply);
+}
+
+/**
+ * Reads and handles every complete message that is waiting on the socket.
+ * Returns false if the client should be disconnected.
+ */
+static bool
+ipc_client_read(struct hwd_ipc_client *client) {
+    while (true) {
+        char *buffer;
+        size_t wanted;
+        if (client->header_length < HWD_IPC_HEADER_LENGTH) {
+            buffer = client->header + client->header_length;
+            wanted = HWD_IPC_HEADER_LENGTH - client->header_length;
+        } else {
+            buffer = client->payload + client->payload_read;
+            wanted = client->payload_length - client->payload_read;
+        }
+
+        ssize_t received = 0;
+        if (wanted > 0) {
+            received = read(client->fd, buffer, wanted);
+            if (received == -1 && errno == EINTR) {
+                continue;
+            }
+            if (received == -1 && errno == EAGAIN) {
+                return true;
+            }
+            if (received <= 0) {
+                return false;
+            }
+        }
+
+        if (client->header_length < HWD_IPC_HEADER_LENGTH) {
+            client->header_length += received;
+            if (client->header_length < HWD_IPC_HEADER_LENGTH) {
+                continue;
+            }
+
+            if (memcmp(client->header, HWD_IPC_MAGIC, HWD_IPC_MAGIC_LENGTH) != 0) {
+                wlr_log(WLR_INFO, "IPC client %d sent a message with a bad header", client->fd);
+                return false;
+            }
+            uint32_t length;
+            memcpy(&length, client->header + HWD_IPC_MAGIC_LENGTH, sizeof(uint32_t));
+            memcpy(
+                &client->payload_type, client->header + HWD_IPC_MAGIC_LENGTH + sizeof(uint32_t),
+                sizeof(uint32_t)
+            );
+            if (length > IPC_MAX_PAYLOAD_LENGTH) {
+                wlr_log(WLR_INFO, "IPC client %d sent a message that is too long", client->fd);
+                return false;
+            }
+
+            if (length + 1 > client->payload_capacity) {
+                client->payload = realloc(client->payload, length + 1);
+                assert(client->payload != NULL);
+                client->payload_capacity = length + 1;
+            }
+            client->payload_length = length;
+            client->payload_read = 0;
+        } else {
+            client->payload_read += received;
+        }
+
+        if (client->payload_read < client->payload_length) {
+            continue;
+        }
+
+        client->payload[client->payload_length] = '\0';
+        client->header_length = 0;
+        if (!ipc_client_handle_message(client)) {
+            return false;
+        }
+    }
+}
+
+static int
+handle_client_event(int fd, uint32_t mask, void *data) {
+    struct hwd_ipc_client *client = data;
+
+    if (mask & WL_EVENT_ERROR) {
+        wlr_log(WLR_ERROR, "IPC client %d socket error", client->fd);
+        ipc_client_destroy(client);
+        return 0;
+    }
+
+    if (mask & WL_EVENT_READABLE) {
+        client->server->dispatching = client;
+        bool ok = ipc_client_read(client);
+        client->server->dispatching = NULL;
+        if (!ok) {
+            ipc_client_destroy(client);
+            return 0;
+        }
+    }
+
+    // Replies to requests that were just read are written here as well.
+    if (!ipc_client_flush(client)) {
+        ipc_client_destroy(client);
+        return 0;
+    }
+
+    if (mask & WL_EVENT_HANGUP) {
+        ipc_client_destroy(client);
+    }
+
+    return 0;
+}
+
+static int
+handle_connection(int fd, uint32_t mask, void *data) {
+    struct hwd_ipc_server *server = data;
+
+    int client_fd = accept(fd, NULL, NULL);
+    if (client_fd == -1) {
+        wlr_log_errno(WLR_ERROR, "Unable to accept IPC client");
+        return 0;
+    }
+    if (!ipc_set_nonblocking(client_fd)) {
+        wlr_log_errno(WLR_ERROR, "Unable to configure IPC client socket");
+        close(client_fd);
+        return 0;
+    }
+
+    struct hwd_ipc_client *client = calloc(1, sizeof(struct hwd_ipc_client));
+    assert(client != NULL);
+
+    client->server = server;
+    client->fd = client_fd;
+    client->send_fd = -1;
+    client->event_source = wl_event_loop_add_fd(
+        server->event_loop, client_fd, WL_EVENT_READABLE, handle_client_event, client
+    );
+    assert(client->event_source != NULL);
+    wl_list_insert(&server->clients, &client->link);
+
+    wlr_log(WLR_DEBUG, "New IPC client %d", client_fd);
+
+    return 0;
+}
+
+/**
+ * Regenerates an event and, if it has changed since it was last sent, marks it
+ * as pending for every client that is subscribed to it.  Returns false if no
+ * client needs to be told about it.
+ */
+static bool
+ipc_server_update_event(struct hwd_ipc_server *server, enum hwd_ipc_event event) {
+    uint32_t bit = 1u << event;
+
+    bool subscribed = false;
+    struct hwd_ipc_client *client;
+    wl_list_for_each(client, &server->clients, link) {
+        subscribed = subscribed || (client->subscriptions & bit);
+    }
+    if (!subscribed) {
+        free(server->last_events[event]);
+        server->last_events[event] = NULL;
+        return false;
+    }
+
+    char *payload = ipc_json_to_string(ipc_describe(event));
+    if (server->last_events[event] != NULL && strcmp(payload, server->last_events[event]) == 0) {
+        free(payload);
+        return false;
+    }
+    free(server->last_events[event]);
+    server->last_events[event] = payload;
+
+    wl_list_for_each(client, &server->clients, link) {
+        if (client->subscriptions & bit) {
+            client->pending_events |= bit;
+        }
+    }
+    return true;
+}
+
+static void
+ipc_server_flush_events(struct hwd_ipc_server *server) {
+    struct hwd_ipc_client *client, *tmp;
+    wl_list_for_each_safe(client, tmp, &server->clients, link) {
+        // Clients that are still writing get their events once they drain.
+        if (client->pending_events == 0 || client->write_length > 0) {
+            continue;
+        }
+        if (client == server->dispatching) {
+            continue;
+        }
+        if (!ipc_client_flush(client)) {
+            ipc_client_destroy(client);
+        }
+    }
+}
+
+static void
+handle_transaction_after_apply(struct wl_listener *listener, void *data) {
+    struct hwd_ipc_server *server = wl_container_of(listener, server, transaction_after_apply);
+
+    HWD_PROFILER_TRACE();
+
+    bool changed = false;
+    changed = ipc_server_update_event(server, HWD_IPC_EVENT_WORKSPACE) || changed;
+    changed = ipc_server_update_event(server, HWD_IPC_EVENT_OUTPUT) || changed;
+    changed = ipc_server_update_event(server, HWD_IPC_EVENT_WINDOW) || changed;
+    changed = ipc_server_update_event(server, HWD_IPC_EVENT_FOCUS) || changed;
+    if (changed) {
+        ipc_server_flush_events(server);
+    }
+}
+
+struct hwd_ipc_server *
+ipc_server_create(
+    struct wl_event_loop *event_loop, struct hwd_transaction_manager *transaction_manager
+) {
+    const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+    if (runtime_dir == NULL) {
+        wlr_log(WLR_ERROR, "XDG_RUNTIME_DIR is not set, not starting IPC server");
+        return NULL;
+    }
+
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+    int path_length = snprintf(
+        address.sun_path, sizeof(address.sun_path), "%s/hayward-ipc.%u.%i.sock", runtime_dir,
+        (unsigned)getuid(), (int)getpid()
+    );
+    if (path_length < 0 || (size_t)path_length >= sizeof(address.sun_path)) {
+        wlr_log(WLR_ERROR, "IPC socket path is too long, not starting IPC server");
+        return NULL;
+    }
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) {
+        wlr_log_errno(WLR_ERROR, "Unable to create IPC socket");
+        return NULL;
+    }
+    if (!ipc_set_nonblocking(fd)) {
+        wlr_log_errno(WLR_ERROR, "Unable to configure IPC socket");
+        close(fd);
+        return NULL;
+    }
+
+    // A socket left over from a previous instance with the same pid.
+    unlink(address.sun_path);
+    if (bind(fd, (struct sockaddr *)&address, sizeof(address)) == -1 || listen(fd, 16) == -1) {
+        wlr_log_errno(WLR_ERROR, "Unable to listen on IPC socket %s", address.sun_path);
+        close(fd);
+        return NULL;
+    }
+
+    struct hwd_ipc_server *server = calloc(1, sizeof(struct hwd_ipc_server));
+    assert(server != NULL);
+
+    server->socket_path = strdup(address.sun_path);
+    assert(server->socket_path != NULL);
+    server->fd = fd;
+    server->event_loop = event_loop;
+    server->transaction_manager = transaction_manager;
+    wl_list_init(&server->clients);
+
+    server->event_source =
+        wl_event_loop_add_fd(event_loop, fd, WL_EVENT_READABLE, handle_connection, server);
+    assert(server->event_source != NULL);
+
+    server->transaction_after_apply.notify = handle_transaction_after_apply;
+    wl_signal_add(&transaction_manager->events.after_apply, &server->transaction_after_apply);
+
+    setenv("HAYWARDSOCK", server->socket_path, true);
+
+    wlr_log(WLR_INFO, "Listening for IPC clients on %s", server->socket_path);
+
+    return server;
+}
+
+void
+ipc_server_destroy(struct hwd_ipc_server *server) {
+    if (server == NULL) {
+        return;
+    }
+
+    struct hwd_ipc_client *client, *tmp;
+    wl_list_for_each_safe(client, tmp, &server->clients, link) {
+        ipc_client_destroy(client);
+    }
+
+    wl_list_remove(&server->transaction_after_apply.link);
+    wl_event_source_remove(server->event_source);
+    close(server->fd);
+    unlink(server->socket_path);
+
+    snapshot_destroy(server->snapshot);
+
+    for (int i = 0; i < HWD_IPC_EVENT_COUNT; i++) {
+        free(server->last_events[i]);
+    }
+    free(server->socket_path);
+    free(server);
+}
+
+void
+ipc_server_notify_mode(struct hwd_ipc_server *server) {
+    if (server == NULL) {
+        return;
+    }
+
+    if (ipc_server_update_event(server, HWD_IPC_EVENT_MODE)) {
+        ipc_server_flush_events(server);
+    }
+}
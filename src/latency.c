@@ -0,0 +1,183 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/latency.h"
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+#include <wayland-server-core.h>
+
+#include <wlr/util/log.h>
+
+// Input event timestamps that are further in the past than this are assumed
+// to come from a device with a broken clock and are ignored.
+#define LATENCY_MAX_EVENT_AGE_MSEC 60000
+
+static const char *latency_metric_names[LATENCY_METRIC_COUNT] = {
+    [LATENCY_KEY_TO_CLIENT] = "key to client",
+    [LATENCY_KEY_TO_BINDING] = "key to binding",
+    [LATENCY_KEY_TO_APPLY] = "key to apply",
+    [LATENCY_POINTER_MOTION] = "pointer motion",
+    [LATENCY_POINTER_BUTTON] = "pointer button",
+    [LATENCY_TRANSACTION_COMMIT] = "transaction commit",
+    [LATENCY_TRANSACTION_CONFIRM] = "transaction confirm",
+    [LATENCY_TRANSACTION_APPLY] = "transaction apply",
+    [LATENCY_INPUT_HOTPLUG] = "input hotplug",
+};
+
+static struct {
+    bool enabled;
+    struct wl_event_source *dump_signal;
+    struct latency_histogram histograms[LATENCY_METRIC_COUNT];
+} latency;
+
+static uint64_t
+latency_clock_usec(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+}
+
+static int
+latency_histogram_bucket(uint64_t value) {
+    if (value < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return value;
+    }
+    int exponent = 63 - __builtin_clzll(value);
+    int sub_bucket = (value >> (exponent - 3)) & (LATENCY_HISTOGRAM_SUB_BUCKETS - 1);
+    return (exponent - 2) * LATENCY_HISTOGRAM_SUB_BUCKETS + sub_bucket;
+}
+
+/**
+ * Returns the largest value that falls into a bucket.
+ */
+static uint64_t
+latency_histogram_bucket_max(int bucket) {
+    if (bucket < LATENCY_HISTOGRAM_SUB_BUCKETS) {
+        return bucket;
+    }
+    int exponent = bucket / LATENCY_HISTOGRAM_SUB_BUCKETS + 2;
+    uint64_t sub_bucket = bucket % LATENCY_HISTOGRAM_SUB_BUCKETS;
+    uint64_t min = (LATENCY_HISTOGRAM_SUB_BUCKETS + sub_bucket) << (exponent - 3);
+    return min + ((uint64_t)1 << (exponent - 3)) - 1;
+}
+
+static uint64_t
+latency_histogram_percentile(const struct latency_histogram *histogram, int percentile) {
+    uint64_t rank = (histogram->count * percentile + 99) / 100;
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if (seen >= rank) {
+            uint64_t value = latency_histogram_bucket_max(i);
+            return value < histogram->max_usec ? value : histogram->max_usec;
+        }
+    }
+    return histogram->max_usec;
+}
+
+static void
+latency_dump(void) {
+    wlr_log(
+        WLR_INFO, "%-20s %10s %10s %10s %10s %10s %10s", "latency (usec)", "count", "mean", "p50",
+        "p90", "p99", "max"
+    );
+    for (int i = 0; i < LATENCY_METRIC_COUNT; i++) {
+        const struct latency_histogram *histogram = &latency.histograms[i];
+        if (histogram->count == 0) {
+            wlr_log(WLR_INFO, "%-20s %10d", latency_metric_names[i], 0);
+            continue;
+        }
+        wlr_log(
+            WLR_INFO, "%-20s %10lu %10lu %10lu %10lu %10lu %10lu", latency_metric_names[i],
+            (unsigned long)histogram->count,
+            (unsigned long)(histogram->sum_usec / histogram->count),
+            (unsigned long)latency_histogram_percentile(histogram, 50),
+            (unsigned long)latency_histogram_percentile(histogram, 90),
+            (unsigned long)latency_histogram_percentile(histogram, 99),
+            (unsigned long)histogram->max_usec
+        );
+    }
+}
+
+static int
+handle_dump_signal(int signal_number, void *data) {
+    latency_dump();
+    return 0;
+}
+
+void
+latency_init(struct wl_event_loop *event_loop) {
+    latency.enabled = true;
+    latency.dump_signal = wl_event_loop_add_signal(event_loop, SIGUSR1, handle_dump_signal, NULL);
+    if (latency.dump_signal == NULL) {
+        wlr_log(WLR_ERROR, "Unable to listen for SIGUSR1, latency will only be logged on exit");
+    }
+}
+
+void
+latency_fini(void) {
+    if (!latency.enabled) {
+        return;
+    }
+
+    latency_dump();
+
+    if (latency.dump_signal != NULL) {
+        wl_event_source_remove(latency.dump_signal);
+        latency.dump_signal = NULL;
+    }
+    latency.enabled = false;
+}
+
+uint64_t
+latency_now(void) {
+    if (!latency.enabled) {
+        return 0;
+    }
+    return latency_clock_usec();
+}
+
+uint64_t
+latency_event_time(uint32_t time_msec) {
+    if (!latency.enabled) {
+        return 0;
+    }
+
+    // Event timestamps are CLOCK_MONOTONIC truncated to 32 bits of
+    // milliseconds, so work out how far in the past they are with wrapping
+    // arithmetic.
+    uint64_t now = latency_clock_usec();
+    uint32_t age_msec = (uint32_t)(now / 1000) - time_msec;
+    if (age_msec > LATENCY_MAX_EVENT_AGE_MSEC) {
+        return 0;
+    }
+    return now - (uint64_t)age_msec * 1000;
+}
+
+void
+latency_record(enum latency_metric metric, uint64_t begin_usec) {
+    if (!latency.enabled || begin_usec == 0) {
+        return;
+    }
+
+    uint64_t now = latency_clock_usec();
+    uint64_t elapsed = now > begin_usec ? now - begin_usec : 0;
+
+    struct latency_histogram *histogram = &latency.histograms[metric];
+    histogram->count++;
+    histogram->sum_usec += elapsed;
+    if (elapsed > histogram->max_usec) {
+        histogram->max_usec = elapsed;
+    }
+    histogram->buckets[latency_histogram_bucket(elapsed)]++;
+}
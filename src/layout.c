@@ -0,0 +1,315 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/layout.h"
+
+#include <limits.h>
+#include <math.h>
+#include <stdbool.h>
+
+void
+hwd_layout_tiling(
+    const struct hwd_layout_box *area, double gap, struct hwd_layout_tiling_column *columns,
+    int count
+) {
+    if (count == 0) {
+        return;
+    }
+
+    // Count the number of new columns we are resizing, and how much space
+    // is currently occupied.
+    int new_columns = 0;
+    double current_width_fraction = 0;
+    for (int i = 0; i < count; i++) {
+        current_width_fraction += columns[i].width_fraction;
+        if (columns[i].width_fraction <= 0) {
+            new_columns += 1;
+        }
+    }
+
+    double total_width_fraction = 0;
+    for (int i = 0; i < count; i++) {
+        struct hwd_layout_tiling_column *column = &columns[i];
+
+        if (column->width_fraction <= 0) {
+            if (current_width_fraction <= 0) {
+                column->width_fraction = 1.0;
+            } else if (count > new_columns) {
+                column->width_fraction = current_width_fraction / (count - new_columns);
+            } else {
+                column->width_fraction = current_width_fraction;
+            }
+        }
+        total_width_fraction += column->width_fraction;
+    }
+
+    // Normalize width fractions so the sum is 1.0.
+    for (int i = 0; i < count; i++) {
+        columns[i].width_fraction /= total_width_fraction;
+    }
+
+    double columns_total_width = area->width - gap * (count - 1);
+
+    double column_x = area->x;
+    for (int i = 0; i < count; i++) {
+        struct hwd_layout_tiling_column *column = &columns[i];
+
+        column->box.x = column_x;
+        column->box.y = area->y;
+        column->box.width = round(column->width_fraction * columns_total_width);
+        column->box.height = area->height;
+        column_x += column->box.width + gap;
+
+        // Make last child use remaining width of parent.
+        if (i == count - 1) {
+            column->box.width = area->x + area->width - column->box.x;
+        }
+    }
+}
+
+void
+hwd_layout_column_prepare(
+    struct hwd_layout_column *column, const struct hwd_layout_column_child *children, int count
+) {
+    column->visible_height_fraction = 0.0;
+    column->available_content_height = column->box.height;
+
+    for (int i = 0; i < count; i++) {
+        const struct hwd_layout_column_child *child = &children[i];
+        if (child->fullscreen) {
+            continue;
+        }
+        if (!column->stacked) {
+            column->visible_height_fraction += child->height_fraction;
+        }
+        column->available_content_height -= child->titlebar_height;
+    }
+
+    if (column->show_preview) {
+        if (!column->stacked) {
+            column->visible_height_fraction += column->preview_height_fraction;
+        }
+        column->available_content_height -= column->preview_titlebar_height;
+    }
+}
+
+int
+hwd_layout_column_resume_index(
+    const struct hwd_layout_column *prev, int prev_count, const struct hwd_layout_column *next,
+    int count, int first_changed
+) {
+    if (prev->stacked != next->stacked || prev->box.x != next->box.x ||
+        prev->box.y != next->box.y || prev->box.width != next->box.width ||
+        prev->box.height != next->box.height) {
+        return 0;
+    }
+
+    // Changing the total share of the column allocated to content resizes
+    // every child.
+    if (prev->visible_height_fraction != next->visible_height_fraction ||
+        prev->available_content_height != next->available_content_height) {
+        return 0;
+    }
+
+    if (prev->show_preview != next->show_preview) {
+        return 0;
+    }
+    if (next->show_preview &&
+        (prev->preview_titlebar_height != next->preview_titlebar_height ||
+         prev->preview_height_fraction != next->preview_height_fraction ||
+         prev->preview_baseline != next->preview_baseline ||
+         prev->preview_anchor_y != next->preview_anchor_y)) {
+        return 0;
+    }
+
+    if (first_changed == count && first_changed == prev_count) {
+        return count;
+    }
+
+    // The preview is positioned relative to all of the children, so any change
+    // means starting again from the top.  We also can't resume past the end of
+    // the previous layout as we don't know where it finished.
+    if (next->show_preview || first_changed >= prev_count) {
+        return 0;
+    }
+
+    return first_changed;
+}
+
+static double
+hwd_layout_column_preview_height(struct hwd_layout_column *column) {
+    double preview_height = column->preview_titlebar_height;
+    if (column->stacked) {
+        preview_height += column->available_content_height;
+    } else {
+        preview_height += column->available_content_height * column->preview_height_fraction /
+            column->visible_height_fraction;
+    }
+    return preview_height;
+}
+
+static void
+hwd_layout_column_place_preview(struct hwd_layout_column *column, int index, double y_offset) {
+    column->preview_index = index;
+    column->preview_box.x = column->box.x;
+    column->preview_box.y = column->box.y + round(y_offset);
+    column->preview_box.width = column->box.width;
+    column->preview_box.height = round(hwd_layout_column_preview_height(column));
+}
+
+void
+hwd_layout_column(
+    struct hwd_layout_column *column, struct hwd_layout_column_child *children, int count,
+    int first
+) {
+    // Distance between top of next window and top of the column.
+    double y_offset = 0;
+    if (first > 0 && first < count) {
+        y_offset = children[first].y_offset;
+    }
+
+    // The distance, in layout coordinates, between the desired location of the
+    // vertical anchor point in the preview and the top of the preview.
+    double preview_baseline = round(column->preview_baseline * column->preview_height_fraction);
+
+    // Absolute distance between preview baseline and anchor point if preview is
+    // inserted before this one.
+    double baseline_delta;
+
+    // Absolute distance between preview baseline and anchor point if preview is
+    // inserted after this one.
+    double next_baseline_delta;
+
+    bool preview_inserted = false;
+
+    next_baseline_delta = fabs(column->box.y + preview_baseline - column->preview_anchor_y);
+
+    for (int i = first; i < count; i++) {
+        struct hwd_layout_column_child *child = &children[i];
+
+        child->y_offset = y_offset;
+        if (child->fullscreen) {
+            continue;
+        }
+
+        double window_height = child->titlebar_height;
+        if (column->stacked) {
+            child->shaded = !child->active;
+            if (child->active) {
+                window_height += column->available_content_height;
+            }
+        } else {
+            child->shaded = false;
+            window_height += column->available_content_height * child->height_fraction /
+                column->visible_height_fraction;
+        }
+
+        baseline_delta = next_baseline_delta;
+        next_baseline_delta = fabs(
+            column->box.y + round(y_offset + window_height) + preview_baseline -
+            column->preview_anchor_y
+        );
+        if (column->show_preview && !preview_inserted && next_baseline_delta > baseline_delta) {
+            hwd_layout_column_place_preview(column, i, y_offset);
+            preview_inserted = true;
+
+            y_offset += hwd_layout_column_preview_height(column);
+            child->y_offset = y_offset;
+        }
+
+        child->y = column->box.y + round(y_offset);
+        child->height = round(window_height);
+
+        y_offset += child->height;
+
+        // TODO Make last visible child use remaining height of parent
+    }
+
+    if (column->show_preview && !preview_inserted) {
+        hwd_layout_column_place_preview(column, count, y_offset);
+        preview_inserted = true;
+    }
+}
+
+void
+hwd_layout_window_floating(
+    const struct hwd_layout_box *output, double center_x, double center_y, double content_width,
+    double content_height, const struct hwd_layout_borders *borders, struct hwd_layout_box *box
+) {
+    double output_center_x = output->x + (center_x * output->width);
+    double output_center_y = output->y + (center_y * output->height);
+
+    box->x = output_center_x - (content_width / 2) - borders->left;
+    box->y = output_center_y - (content_height / 2) - borders->titlebar_height - borders->top;
+    box->width = content_width + borders->left + borders->right;
+    box->height = content_height + borders->titlebar_height + borders->top + borders->bottom;
+}
+
+void
+hwd_layout_window_content(
+    const struct hwd_layout_box *box, const struct hwd_layout_borders *borders,
+    struct hwd_layout_box *content
+) {
+    content->x = box->x + borders->left;
+    content->y = box->y + borders->titlebar_height + borders->top;
+    content->width = box->width - borders->left - borders->right;
+    if (content->width < 0) {
+        content->width = 0;
+    }
+    content->height = box->height - borders->titlebar_height - borders->top - borders->bottom;
+    if (content->height < 0) {
+        content->height = 0;
+    }
+}
+
+void
+hwd_layout_floating_constraints(
+    const struct hwd_layout_size_limits *config, const struct hwd_layout_size_limits *window,
+    double layout_width, double layout_height, struct hwd_layout_size_limits *constraints
+) {
+    if (config->min_width == -1) { // no minimum
+        constraints->min_width = 0;
+    } else if (config->min_width == 0) { // automatic
+        constraints->min_width = 75;
+    } else {
+        constraints->min_width = config->min_width;
+    }
+    if (window->min_width != 0) {
+        constraints->min_width = fmax(constraints->min_width, window->min_width);
+    }
+
+    if (config->min_height == -1) { // no minimum
+        constraints->min_height = 0;
+    } else if (config->min_height == 0) { // automatic
+        constraints->min_height = 50;
+    } else {
+        constraints->min_height = config->min_height;
+    }
+    if (window->min_height != 0) {
+        constraints->min_height = fmax(constraints->min_height, window->min_height);
+    }
+
+    if (config->max_width == -1) { // no maximum
+        constraints->max_width = INT_MAX;
+    } else if (config->max_width == 0) { // automatic
+        constraints->max_width = layout_width;
+    } else {
+        constraints->max_width = config->max_width;
+    }
+    if (window->max_width != 0) {
+        constraints->max_width = fmin(constraints->max_width, window->max_width);
+    }
+
+    if (config->max_height == -1) { // no maximum
+        constraints->max_height = INT_MAX;
+    } else if (config->max_height == 0) { // automatic
+        constraints->max_height = layout_height;
+    } else {
+        constraints->max_height = config->max_height;
+    }
+    if (window->max_height != 0) {
+        constraints->max_height = fmin(constraints->max_height, window->max_height);
+    }
+}
@@ -35,7 +35,7 @@ static bool terminate_request = false;
 static int exit_value = 0;
 static struct rlimit original_nofile_rlimit = {0};
 struct hwd_server server = {0};
-struct hwd_debug debug = {0};
+struct hwd_debug debug = {.validate_sweep = 64};
 
 void
 hwd_terminate(int exit_code) {
@@ -226,10 +226,20 @@ enable_debug_flag(const char *flag) {
         debug.noatomic = true;
     } else if (strcmp(flag, "txn-wait") == 0) {
         debug.txn_wait = true;
+    } else if (strcmp(flag, "latency") == 0) {
+        debug.latency = true;
     } else if (strcmp(flag, "profile") == 0) {
         hwd_profiler_init();
     } else if (strncmp(flag, "txn-timeout=", 12) == 0) {
         server.txn_timeout_ms = atoi(&flag[12]);
+    } else if (strcmp(flag, "validate=incremental") == 0) {
+        debug.validate = HWD_DEBUG_VALIDATE_INCREMENTAL;
+    } else if (strcmp(flag, "validate=full") == 0) {
+        debug.validate = HWD_DEBUG_VALIDATE_FULL;
+    } else if (strcmp(flag, "validate=none") == 0) {
+        debug.validate = HWD_DEBUG_VALIDATE_NONE;
+    } else if (strncmp(flag, "validate-sweep=", 15) == 0) {
+        debug.validate_sweep = atoi(&flag[15]);
     } else {
         wlr_log(WLR_ERROR, "Unknown debug flag: %s", flag);
     }
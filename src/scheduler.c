@@ -10,15 +10,22 @@
 #include <stdlib.h>
 #include <time.h>
 
+#include <tearing-control-v1-protocol.h>
+
 #include <wayland-server-core.h>
 #include <wayland-util.h>
 
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_scene.h>
+#include <wlr/types/wlr_tearing_control_v1.h>
 #include <wlr/util/addon.h>
 
 #include <hayward/profiler.h>
 #include <hayward/server.h>
+#include <hayward/tearing.h>
+#include <hayward/tree/output.h>
+#include <hayward/tree/view.h>
+#include <hayward/tree/window.h>
 
 struct buffer_timer {
     struct wlr_addon addon;
@@ -116,25 +123,75 @@ output_repaint_timer_handler(void *data) {
     HWD_PROFILER_TRACE();
 
     struct hwd_scene_output_scheduler *scheduler_output = data;
+    struct wlr_scene_output *scene_output = scheduler_output->scene_output;
+
+    if (!scheduler_output->tearing) {
+        wlr_scene_output_commit(scene_output, NULL);
+        return 0;
+    }
+
+    if (!wlr_scene_output_needs_frame(scene_output)) {
+        return 0;
+    }
 
-    wlr_scene_output_commit(scheduler_output->scene_output, NULL);
+    struct wlr_output_state state;
+    wlr_output_state_init(&state);
+    if (wlr_scene_output_build_state(scene_output, &state, NULL)) {
+        // Not every backend can flip asynchronously, and those that can may
+        // still refuse for some buffers.  Fall back to a normal flip rather
+        // than dropping the frame.
+        state.tearing_page_flip = true;
+        if (!wlr_output_test_state(scene_output->output, &state)) {
+            state.tearing_page_flip = false;
+        }
+        wlr_output_commit_state(scene_output->output, &state);
+    }
+    wlr_output_state_finish(&state);
 
     return 0;
 }
 
+static bool
+scheduler_output_should_tear(struct hwd_scene_output_scheduler *scheduler_output) {
+    struct hwd_output *output = output_from_wlr_output(scheduler_output->scene_output->output);
+
+    struct hwd_tearing_state state = {0};
+    state.locked = server.session_lock.locked;
+
+    struct hwd_window *window = output != NULL ? output->current.fullscreen_window : NULL;
+    if (window != NULL && window->view != NULL && window->view->surface != NULL) {
+        state.has_fullscreen_window = true;
+        state.window_allows_tearing = window->allow_tearing;
+
+        enum wp_tearing_control_v1_presentation_hint hint =
+            wlr_tearing_control_manager_v1_surface_hint_from_surface(
+                server.tearing_control, window->view->surface
+            );
+        state.window_requests_async = hint == WP_TEARING_CONTROL_V1_PRESENTATION_HINT_ASYNC;
+    }
+
+    return hwd_tearing_should_tear(&state);
+}
+
 static void
 handle_output_frame(struct wl_listener *listener, void *user_data) {
     struct hwd_scene_output_scheduler *scheduler_output =
         wl_container_of(listener, scheduler_output, output_frame);
+
     if (!scheduler_output->scene_output->output->enabled) {
         return;
     }
 
+    // A client that has asked to tear wants its buffers on screen as soon as
+    // they are ready, so neither the repaint nor its frame callbacks are
+    // delayed to line up with the refresh.
+    scheduler_output->tearing = scheduler_output_should_tear(scheduler_output);
+
     // Compute predicted milliseconds until the next refresh. It's used for
     // delaying both output rendering and surface frame callbacks.
     int msec_until_refresh = 0;
 
-    if (scheduler_output->max_render_time != 0) {
+    if (scheduler_output->max_render_time != 0 && !scheduler_output->tearing) {
         struct timespec now;
         clock_gettime(CLOCK_MONOTONIC, &now);
 
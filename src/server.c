@@ -5,22 +5,31 @@
 
 #include "hayward/server.h"
 
+#include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <wayland-server-core.h>
+#include <wayland-util.h>
 
 #include <wlr/backend.h>
 #include <wlr/render/allocator.h>
 #include <wlr/render/wlr_renderer.h>
 #include <wlr/types/wlr_buffer.h>
+#include <wlr/types/wlr_commit_timing_v1.h>
 #include <wlr/types/wlr_compositor.h>
 #include <wlr/types/wlr_data_control_v1.h>
 #include <wlr/types/wlr_data_device.h>
 #include <wlr/types/wlr_drm.h>
 #include <wlr/types/wlr_drm_lease_v1.h>
 #include <wlr/types/wlr_export_dmabuf_v1.h>
+#include <wlr/types/wlr_ext_foreign_toplevel_list_v1.h>
+#include <wlr/types/wlr_ext_image_capture_source_v1.h>
+#include <wlr/types/wlr_ext_image_copy_capture_v1.h>
+#include <wlr/types/wlr_fifo_v1.h>
+#include <wlr/types/wlr_fractional_scale_v1.h>
 #include <wlr/types/wlr_gamma_control_v1.h>
 #include <wlr/types/wlr_idle_notify_v1.h>
 #include <wlr/types/wlr_input_method_v2.h>
@@ -34,6 +43,7 @@
 #include <wlr/types/wlr_single_pixel_buffer_v1.h>
 #include <wlr/types/wlr_subcompositor.h>
 #include <wlr/types/wlr_tablet_v2.h>
+#include <wlr/types/wlr_tearing_control_v1.h>
 #include <wlr/types/wlr_text_input_v3.h>
 #include <wlr/types/wlr_viewporter.h>
 #include <wlr/types/wlr_xdg_foreign_registry.h>
@@ -53,8 +63,11 @@
 #include <hayward/desktop/xwayland.h>
 #include <hayward/globals/root.h>
 #include <hayward/input/input_manager.h>
+#include <hayward/ipc.h>
+#include <hayward/latency.h>
 #include <hayward/tree/output.h>
 #include <hayward/tree/root.h>
+#include <hayward/tree/window.h>
 
 bool
 server_privileged_prepare(struct hwd_server *server) {
@@ -70,6 +83,42 @@ server_privileged_prepare(struct hwd_server *server) {
     return true;
 }
 
+struct surface_commit_tracker {
+    struct wl_listener commit;
+    struct wl_listener destroy;
+};
+
+static void
+handle_surface_commit(struct wl_listener *listener, void *data) {
+    // Commits can move, resize or replace anything the cursor's hit-test
+    // cache was derived from, not just the surface it found.
+    root->scene_generation++;
+}
+
+static void
+handle_surface_destroy(struct wl_listener *listener, void *data) {
+    struct surface_commit_tracker *tracker = wl_container_of(listener, tracker, destroy);
+
+    root->scene_generation++;
+
+    wl_list_remove(&tracker->commit.link);
+    wl_list_remove(&tracker->destroy.link);
+    free(tracker);
+}
+
+static void
+handle_new_surface(struct wl_listener *listener, void *data) {
+    struct wlr_surface *surface = data;
+
+    struct surface_commit_tracker *tracker = calloc(1, sizeof(struct surface_commit_tracker));
+    assert(tracker != NULL);
+
+    tracker->commit.notify = handle_surface_commit;
+    wl_signal_add(&surface->events.commit, &tracker->commit);
+    tracker->destroy.notify = handle_surface_destroy;
+    wl_signal_add(&surface->events.destroy, &tracker->destroy);
+}
+
 static void
 handle_drm_lease_request(struct wl_listener *listener, void *data) {
     /* We only offer non-desktop outputs, but in the future we might want to do
@@ -83,6 +132,23 @@ handle_drm_lease_request(struct wl_listener *listener, void *data) {
     }
 }
 
+static void
+handle_window_capture_request(struct wl_listener *listener, void *data) {
+    struct wlr_ext_foreign_toplevel_image_capture_source_manager_v1_request *request = data;
+
+    struct hwd_window *window = request->toplevel_handle->data;
+    if (window == NULL) {
+        return;
+    }
+
+    struct wlr_ext_image_capture_source_v1 *source = window_get_image_capture_source(window);
+    if (source == NULL) {
+        return;
+    }
+
+    wlr_ext_foreign_toplevel_image_capture_source_manager_v1_request_accept(request, source);
+}
+
 bool
 server_init(struct hwd_server *server) {
     wlr_log(WLR_DEBUG, "Initializing Wayland server");
@@ -108,6 +174,8 @@ server_init(struct hwd_server *server) {
     }
 
     server->compositor = wlr_compositor_create(server->wl_display, 5, server->renderer);
+    server->new_surface.notify = handle_new_surface;
+    wl_signal_add(&server->compositor->events.new_surface, &server->new_surface);
     wlr_subcompositor_create(server->wl_display);
 
     server->data_device_manager = wlr_data_device_manager_create(server->wl_display);
@@ -161,11 +229,39 @@ server_init(struct hwd_server *server) {
 
     wlr_export_dmabuf_manager_v1_create(server->wl_display);
     wlr_screencopy_manager_v1_create(server->wl_display);
+
+    // Unlike screencopy, image copy capture only sends a frame once the source
+    // has been damaged, and reports which regions changed, so clients can skip
+    // idle frames and copy only what changed.  Output sources are damaged by
+    // the scene when outputs are committed.
+    wlr_ext_image_copy_capture_manager_v1_create(server->wl_display, 1);
+    wlr_ext_output_image_capture_source_manager_v1_create(server->wl_display, 1);
+    server->window_capture_manager =
+        wlr_ext_foreign_toplevel_image_capture_source_manager_v1_create(server->wl_display, 1);
+    server->window_capture_request.notify = handle_window_capture_request;
+    wl_signal_add(
+        &server->window_capture_manager->events.new_request, &server->window_capture_request
+    );
     wlr_data_control_manager_v1_create(server->wl_display);
     wlr_primary_selection_v1_device_manager_create(server->wl_display);
     wlr_viewporter_create(server->wl_display);
     wlr_single_pixel_buffer_manager_v1_create(server->wl_display);
 
+    // Preferred scales are sent by the scene graph, from the same output
+    // enter and leave tracking that drives `wl_surface.enter`, so there is
+    // nothing to do here beyond advertising the global.
+    wlr_fractional_scale_manager_v1_create(server->wl_display, 1);
+
+    // Both hold client commits back until they can be shown: FIFO barriers
+    // until the surface's output has presented, commit timing until the
+    // target time.  wlroots releases them from the output commit and present
+    // events that `hwd_scene_output_scheduler` already drives, so targets
+    // line up with the refresh cycle that the scheduler predicts.
+    wlr_fifo_manager_v1_create(server->wl_display, 1);
+    wlr_commit_timing_manager_v1_create(server->wl_display, 1);
+
+    server->tearing_control = wlr_tearing_control_manager_v1_create(server->wl_display, 1);
+
     struct wlr_xdg_foreign_registry *foreign_registry =
         wlr_xdg_foreign_registry_create(server->wl_display);
     wlr_xdg_foreign_v1_create(server->wl_display, foreign_registry);
@@ -194,15 +290,23 @@ server_init(struct hwd_server *server) {
         server->txn_timeout_ms = 200;
     }
 
+    if (debug.latency) {
+        latency_init(server->wl_event_loop);
+    }
+
     server->input = input_manager_create(server->wl_display, server->backend);
     input_manager_get_default_seat(); // create seat0
 
+    server->ipc = ipc_server_create(server->wl_event_loop, root_get_transaction_manager(root));
+
     return true;
 }
 
 void
 server_fini(struct hwd_server *server) {
     // TODO: free hayward-specific resources
+    ipc_server_destroy(server->ipc);
+    latency_fini();
 #if HAVE_XWAYLAND
     hwd_xwayland_destroy(server->xwayland);
 #endif
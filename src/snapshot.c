@@ -0,0 +1,343 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+// Needed for memfd_create and file sealing.
+#define _GNU_SOURCE
+
+#include "hayward/snapshot.h"
+
+#include <assert.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <wayland-server-core.h>
+#include <wayland-util.h>
+
+#include <wlr/types/wlr_output.h>
+#include <wlr/util/log.h>
+
+#include <hayward/globals/root.h>
+#include <hayward/list.h>
+#include <hayward/profiler.h>
+#include <hayward/tree/column.h>
+#include <hayward/tree/output.h>
+#include <hayward/tree/root.h>
+#include <hayward/tree/transaction.h>
+#include <hayward/tree/window.h>
+#include <hayward/tree/workspace.h>
+
+#define SNAPSHOT_MIN_CAPACITY 4096
+
+#define SNAPSHOT_ALIGN(offset) (((offset) + 7) & ~(size_t)7)
+
+struct snapshot_layout {
+    uint32_t output_count;
+    uint32_t workspace_count;
+    uint32_t window_count;
+    uint32_t string_length;
+};
+
+static uint32_t
+snapshot_string_length(const char *string) {
+    return (string == NULL || string[0] == '\0') ? 0 : strlen(string) + 1;
+}
+
+static uint32_t
+snapshot_add_string(char *strings, uint32_t *length, const char *string) {
+    uint32_t string_length = snapshot_string_length(string);
+    if (string_length == 0) {
+        return 0;
+    }
+    uint32_t offset = *length;
+    memcpy(strings + offset, string, string_length);
+    *length += string_length;
+    return offset;
+}
+
+static void
+snapshot_measure_window(struct snapshot_layout *layout, struct hwd_window *window) {
+    layout->window_count++;
+    layout->string_length += snapshot_string_length(window->title);
+}
+
+static void
+snapshot_measure(struct snapshot_layout *layout) {
+    // The empty string.
+    layout->string_length = 1;
+
+    struct hwd_output *output;
+    wl_list_for_each(output, &root->all_outputs, link) {
+        if (output->current.dead) {
+            continue;
+        }
+        layout->output_count++;
+        layout->string_length += snapshot_string_length(output->wlr_output->name);
+    }
+
+    for (int i = 0; i < root->workspaces->length; i++) {
+        struct hwd_workspace *workspace = root->workspaces->items[i];
+        if (workspace->current.dead) {
+            continue;
+        }
+        layout->workspace_count++;
+        layout->string_length += snapshot_string_length(workspace->name);
+
+        for (int j = 0; j < workspace->current.columns->length; j++) {
+            struct hwd_column *column = workspace->current.columns->items[j];
+            for (int k = 0; k < column->current.children->length; k++) {
+                snapshot_measure_window(layout, column->current.children->items[k]);
+            }
+        }
+        for (int j = 0; j < workspace->current.floating->length; j++) {
+            snapshot_measure_window(layout, workspace->current.floating->items[j]);
+        }
+    }
+}
+
+static bool
+snapshot_reserve(struct hwd_snapshot *snapshot, size_t size) {
+    if (size <= snapshot->capacity) {
+        return true;
+    }
+
+    size_t capacity = snapshot->capacity ? snapshot->capacity : SNAPSHOT_MIN_CAPACITY;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+
+    // Readers map the file themselves, so it must only ever grow.
+    if (ftruncate(snapshot->fd, capacity) == -1) {
+        wlr_log_errno(WLR_ERROR, "Unable to grow layout snapshot to %zu bytes", capacity);
+        return false;
+    }
+    void *data = mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_SHARED, snapshot->fd, 0);
+    if (data == MAP_FAILED) {
+        wlr_log_errno(WLR_ERROR, "Unable to map layout snapshot");
+        return false;
+    }
+
+    if (snapshot->data != NULL) {
+        munmap(snapshot->data, snapshot->capacity);
+    }
+    snapshot->data = data;
+    snapshot->capacity = capacity;
+    return true;
+}
+
+static void
+snapshot_write_window(
+    struct hwd_snapshot_window *record, char *strings, uint32_t *string_length,
+    struct hwd_window *window, uint32_t workspace_index, bool floating
+) {
+    record->id = window->id;
+    record->title = snapshot_add_string(strings, string_length, window->title);
+    record->flags = (window->current.focused ? HWD_SNAPSHOT_WINDOW_FOCUSED : 0) |
+        (window->current.fullscreen ? HWD_SNAPSHOT_WINDOW_FULLSCREEN : 0) |
+        (floating ? HWD_SNAPSHOT_WINDOW_FLOATING : 0) |
+        (window->is_urgent ? HWD_SNAPSHOT_WINDOW_URGENT : 0);
+    record->x = window->current.x;
+    record->y = window->current.y;
+    record->width = window->current.width;
+    record->height = window->current.height;
+    record->workspace = workspace_index;
+    record->reserved = 0;
+}
+
+static void
+snapshot_write(struct hwd_snapshot *snapshot) {
+    HWD_PROFILER_TRACE();
+
+    struct snapshot_layout layout = {0};
+    snapshot_measure(&layout);
+
+    size_t output_offset = SNAPSHOT_ALIGN(sizeof(struct hwd_snapshot_header));
+    size_t workspace_offset =
+        output_offset + layout.output_count * sizeof(struct hwd_snapshot_output);
+    size_t window_offset =
+        workspace_offset + layout.workspace_count * sizeof(struct hwd_snapshot_workspace);
+    size_t string_offset = window_offset + layout.window_count * sizeof(struct hwd_snapshot_window);
+    size_t size = string_offset + layout.string_length;
+
+    if (size > UINT32_MAX || !snapshot_reserve(snapshot, size)) {
+        return;
+    }
+
+    char *data = snapshot->data;
+    struct hwd_snapshot_header *header = snapshot->data;
+
+    uint32_t sequence = atomic_load_explicit(&header->sequence, memory_order_relaxed);
+    atomic_store_explicit(&header->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    header->magic = HWD_SNAPSHOT_MAGIC;
+    header->version = HWD_SNAPSHOT_VERSION;
+    header->size = size;
+    header->output_count = layout.output_count;
+    header->output_offset = output_offset;
+    header->workspace_count = layout.workspace_count;
+    header->workspace_offset = workspace_offset;
+    header->window_count = layout.window_count;
+    header->window_offset = window_offset;
+    header->string_offset = string_offset;
+    header->string_length = layout.string_length;
+    header->active_workspace = -1;
+    header->focused_window = -1;
+
+    char *strings = data + string_offset;
+    uint32_t string_length = 0;
+    strings[string_length++] = '\0';
+
+    struct hwd_snapshot_output *outputs = (struct hwd_snapshot_output *)(data + output_offset);
+    struct hwd_output *output;
+    wl_list_for_each(output, &root->all_outputs, link) {
+        if (output->current.dead) {
+            continue;
+        }
+        struct hwd_snapshot_output *record = outputs++;
+        record->id = output->id;
+        record->name = snapshot_add_string(strings, &string_length, output->wlr_output->name);
+        record->flags = output->current.disabled ? 0 : HWD_SNAPSHOT_OUTPUT_ENABLED;
+        record->x = output->current.x;
+        record->y = output->current.y;
+        record->width = output->current.width;
+        record->height = output->current.height;
+        record->scale = output->wlr_output->scale;
+        record->reserved = 0;
+    }
+
+    struct hwd_snapshot_workspace *workspaces =
+        (struct hwd_snapshot_workspace *)(data + workspace_offset);
+    struct hwd_snapshot_window *windows = (struct hwd_snapshot_window *)(data + window_offset);
+    uint32_t workspace_index = 0;
+    uint32_t window_index = 0;
+    for (int i = 0; i < root->workspaces->length; i++) {
+        struct hwd_workspace *workspace = root->workspaces->items[i];
+        if (workspace->current.dead) {
+            continue;
+        }
+
+        struct hwd_snapshot_workspace *record = &workspaces[workspace_index];
+        record->id = workspace->id;
+        record->name = snapshot_add_string(strings, &string_length, workspace->name);
+        record->flags = (workspace == root->current.workspace ? HWD_SNAPSHOT_WORKSPACE_ACTIVE : 0) |
+            (workspace->current.focused ? HWD_SNAPSHOT_WORKSPACE_FOCUSED : 0) |
+            (workspace->urgent ? HWD_SNAPSHOT_WORKSPACE_URGENT : 0);
+        if (workspace == root->current.workspace) {
+            header->active_workspace = workspace_index;
+        }
+
+        for (int j = 0; j < workspace->current.columns->length; j++) {
+            struct hwd_column *column = workspace->current.columns->items[j];
+            for (int k = 0; k < column->current.children->length; k++) {
+                struct hwd_window *window = column->current.children->items[k];
+                snapshot_write_window(
+                    &windows[window_index], strings, &string_length, window, workspace_index,
+                    false
+                );
+                if (window->current.focused && workspace->current.focused) {
+                    header->focused_window = window_index;
+                }
+                window_index++;
+            }
+        }
+        for (int j = 0; j < workspace->current.floating->length; j++) {
+            struct hwd_window *window = workspace->current.floating->items[j];
+            snapshot_write_window(
+                &windows[window_index], strings, &string_length, window, workspace_index, true
+            );
+            if (window->current.focused && workspace->current.focused) {
+                header->focused_window = window_index;
+            }
+            window_index++;
+        }
+
+        workspace_index++;
+    }
+    assert(string_length == layout.string_length);
+
+    atomic_store_explicit(&header->sequence, sequence + 2, memory_order_release);
+}
+
+static void
+handle_transaction_after_apply(struct wl_listener *listener, void *data) {
+    struct hwd_snapshot *snapshot = wl_container_of(listener, snapshot, transaction_after_apply);
+
+    snapshot_write(snapshot);
+}
+
+struct hwd_snapshot *
+snapshot_create(struct hwd_transaction_manager *transaction_manager) {
+    int fd = memfd_create("hayward-snapshot", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        wlr_log_errno(WLR_ERROR, "Unable to create layout snapshot");
+        return NULL;
+    }
+
+    // Clients are handed a read-only descriptor, but anyone holding a
+    // descriptor can reopen it with more access through `/proc/self/fd`.
+    // Sealing stops them from shrinking the file, which would otherwise crash
+    // us with SIGBUS the next time we wrote through our mapping.  They can
+    // still scribble over their own view of the snapshot.
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_SEAL) == -1) {
+        wlr_log_errno(WLR_ERROR, "Unable to seal layout snapshot");
+        close(fd);
+        return NULL;
+    }
+
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    int read_only_fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (read_only_fd == -1) {
+        wlr_log_errno(WLR_ERROR, "Unable to open layout snapshot");
+        close(fd);
+        return NULL;
+    }
+
+    struct hwd_snapshot *snapshot = calloc(1, sizeof(struct hwd_snapshot));
+    assert(snapshot != NULL);
+
+    snapshot->fd = fd;
+    snapshot->read_only_fd = read_only_fd;
+
+    if (!snapshot_reserve(snapshot, SNAPSHOT_MIN_CAPACITY)) {
+        close(read_only_fd);
+        close(fd);
+        free(snapshot);
+        return NULL;
+    }
+
+    snapshot->transaction_after_apply.notify = handle_transaction_after_apply;
+    wl_signal_add(&transaction_manager->events.after_apply, &snapshot->transaction_after_apply);
+
+    snapshot_write(snapshot);
+
+    return snapshot;
+}
+
+void
+snapshot_destroy(struct hwd_snapshot *snapshot) {
+    if (snapshot == NULL) {
+        return;
+    }
+
+    wl_list_remove(&snapshot->transaction_after_apply.link);
+    munmap(snapshot->data, snapshot->capacity);
+    close(snapshot->read_only_fd);
+    close(snapshot->fd);
+    free(snapshot);
+}
+
+int
+snapshot_get_fd(struct hwd_snapshot *snapshot) {
+    return snapshot->read_only_fd;
+}
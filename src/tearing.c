@@ -0,0 +1,25 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/tearing.h"
+
+#include <stdbool.h>
+
+bool
+hwd_tearing_should_tear(const struct hwd_tearing_state *state) {
+    if (state->locked) {
+        return false;
+    }
+
+    // Anything other than a single fullscreen window would tear along with
+    // it, so only a window that covers the whole output can ask.
+    if (!state->has_fullscreen_window) {
+        return false;
+    }
+
+    // Both the user and the client need to agree.  Clients can't know whether
+    // the user cares more about latency or about the picture being intact.
+    return state->window_allows_tearing && state->window_requests_async;
+}
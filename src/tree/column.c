@@ -6,7 +6,6 @@
 #include "hayward/tree/column.h"
 
 #include <assert.h>
-#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -20,6 +19,7 @@
 #include <wlr/util/log.h>
 
 #include <hayward/globals/root.h>
+#include <hayward/layout.h>
 #include <hayward/list.h>
 #include <hayward/profiler.h>
 #include <hayward/tree/output.h>
@@ -192,6 +192,8 @@ column_destroy(struct hwd_column *column) {
     column_destroy_scene(column);
 
     list_free(column->children);
+    free(column->arrange_cache.windows);
+    free(column->arrange_cache.children);
 
     list_free(column->pending.children);
     list_free(column->committed.children);
@@ -273,129 +275,47 @@ column_set_dirty(struct hwd_column *column) {
 }
 
 static void
-column_arrange_split(struct hwd_column *column) {
-    struct hwd_window *child = NULL;
-
+column_sync_pending_children(struct hwd_column *column) {
     list_t *children = column->pending.children;
-    list_clear(children);
-    for (int i = 0; i < column->children->length; ++i) {
-        struct hwd_window *window = column->children->items[i];
-        list_add(children, window);
-    }
-
-    struct wlr_box box;
-    column_get_box(column, &box);
-
-    double preview_titlebar_height = 30; // TODO TODO TODO
 
-    double visible_height_fraction = 0.0;
-    double available_content_height = box.height;
-    for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        if (window_is_fullscreen(child)) {
-            continue;
-        }
-        visible_height_fraction += child->height_fraction;
-        available_content_height -= child->pending.titlebar_height;
+    bool changed = children->length != column->children->length;
+    for (int i = 0; !changed && i < children->length; ++i) {
+        changed = children->items[i] != column->children->items[i];
     }
-    if (column->pending.show_preview) {
-        visible_height_fraction += column->preview_height_fraction;
-        available_content_height -= preview_titlebar_height;
+    if (!changed) {
+        return;
     }
 
-    // Distance between top of next window and top of the screen.
-    double y_offset = 0;
-
-    // The distance, in layout coordinates, between the desired location of the
-    // vertical anchor point in the preview and the top of the preview.
-    double preview_baseline = round(column->preview_baseline * column->preview_height_fraction);
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted before this one.
-    double baseline_delta;
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted after this one.
-    double next_baseline_delta;
-
-    bool preview_inserted = false;
-
-    next_baseline_delta = fabs(column->pending.y + preview_baseline - column->preview_anchor_y);
-
-    for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        double window_height = child->pending.titlebar_height;
-        if (window_is_fullscreen(child)) {
-            continue;
-        }
-
-        window_height +=
-            available_content_height * child->height_fraction / visible_height_fraction;
-        child->pending.shaded = false;
-
-        baseline_delta = next_baseline_delta;
-        next_baseline_delta = fabs(
-            column->pending.y + round(y_offset + window_height) + preview_baseline -
-            column->preview_anchor_y
-        );
-        if (column->pending.show_preview && !preview_inserted &&
-            next_baseline_delta > baseline_delta) {
-
-            double preview_height = preview_titlebar_height;
-            preview_height += available_content_height * column->preview_height_fraction /
-                visible_height_fraction;
-
-            column->pending.preview_target = window_get_previous_sibling(child);
-            column->pending.preview_box.x = column->pending.x;
-            column->pending.preview_box.y = column->pending.y + round(y_offset);
-            column->pending.preview_box.width = column->pending.width;
-            column->pending.preview_box.height = round(preview_height);
-
-            preview_inserted = true;
-
-            y_offset += preview_height;
-        }
-
-        child->pending.x = column->pending.x;
-        child->pending.y = column->pending.y + round(y_offset);
-        child->pending.width = box.width;
-        child->pending.height = round(window_height);
+    list_clear(children);
+    list_cat(children, column->children);
+}
 
-        y_offset += child->pending.height;
+static void
+column_arrange_cache_reserve(struct hwd_column_arrange_cache *cache, int length) {
+    if (cache->capacity >= length) {
+        return;
     }
 
-    if (column->pending.show_preview && !preview_inserted) {
-        double preview_height = preview_titlebar_height;
-        preview_height +=
-            available_content_height * column->preview_height_fraction / visible_height_fraction;
-
-        column->pending.preview_target = child;
-        column->pending.preview_box.x = column->pending.x;
-        column->pending.preview_box.y = column->pending.y + round(y_offset);
-        column->pending.preview_box.width = column->pending.width;
-        column->pending.preview_box.height = round(preview_height);
+    int capacity = cache->capacity > 0 ? cache->capacity : 8;
+    while (capacity < length) {
+        capacity *= 2;
+    }
 
-        preview_inserted = true;
+    cache->windows = realloc(cache->windows, sizeof(struct hwd_window *) * capacity);
+    assert(cache->windows != NULL);
 
-        y_offset += preview_height;
-    }
+    cache->children = realloc(cache->children, sizeof(struct hwd_layout_column_child) * capacity);
+    assert(cache->children != NULL);
 
-    for (int i = 0; i < column->pending.children->length; i++) {
-        struct hwd_window *window = column->pending.children->items[i];
-        window_set_dirty(window);
-    }
+    cache->capacity = capacity;
 }
 
 static void
-column_arrange_stacked(struct hwd_column *column) {
-    struct hwd_window *child = NULL;
+column_arrange_children(struct hwd_column *column) {
+    struct hwd_column_arrange_cache *cache = &column->arrange_cache;
 
+    column_sync_pending_children(column);
     list_t *children = column->pending.children;
-    list_clear(children);
-    for (int i = 0; i < column->children->length; ++i) {
-        struct hwd_window *window = column->children->items[i];
-        list_add(children, window);
-    }
 
     struct hwd_window *active_child = column->active_child;
     if (column->pending.show_preview) {
@@ -405,100 +325,97 @@ column_arrange_stacked(struct hwd_column *column) {
     struct wlr_box box;
     column_get_box(column, &box);
 
-    double preview_titlebar_height = 30; // TODO TODO TODO
-
-    double available_content_height = box.height;
-    for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        if (window_is_fullscreen(child)) {
+    struct hwd_layout_column params = {
+        .stacked = column->layout == L_STACKED,
+        .box = {.x = box.x, .y = box.y, .width = box.width, .height = box.height},
+        .show_preview = column->pending.show_preview,
+        .preview_titlebar_height = 30, // TODO TODO TODO
+        .preview_height_fraction = column->preview_height_fraction,
+        .preview_baseline = column->preview_baseline,
+        .preview_anchor_y = column->preview_anchor_y,
+    };
+
+    int prev_length = cache->valid ? cache->length : 0;
+    column_arrange_cache_reserve(cache, children->length);
+
+    // Find the first child whose inputs differ from those used by the previous
+    // layout, and refresh the inputs of every child from there on.
+    int first_changed = 0;
+    for (int i = 0; i < children->length; i++) {
+        struct hwd_window *window = children->items[i];
+        struct hwd_layout_column_child *child = &cache->children[i];
+
+        if (first_changed == i && i < prev_length && cache->windows[i] == window &&
+            child->height_fraction == window->height_fraction &&
+            child->titlebar_height == window->pending.titlebar_height &&
+            child->fullscreen == window_is_fullscreen(window) &&
+            child->active == (window == active_child)) {
+            first_changed++;
             continue;
         }
-        available_content_height -= child->pending.titlebar_height;
-    }
-    if (column->pending.show_preview) {
-        available_content_height -= preview_titlebar_height;
-    }
-
-    // Distance between top of next window and top of the screen.
-    double y_offset = 0;
 
-    // The distance, in layout coordinates, between the desired location of the
-    // vertical anchor point in the preview and the top of the preview.
-    double preview_baseline = round(column->preview_baseline * column->preview_height_fraction);
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted before this one.
-    double baseline_delta;
-
-    // Absolute distance between preview baseline and anchor point if preview is
-    // inserted after this one.
-    double next_baseline_delta;
-
-    bool preview_inserted = false;
-
-    next_baseline_delta = fabs(column->pending.y + preview_baseline - column->preview_anchor_y);
-
-    for (int i = 0; i < children->length; ++i) {
-        child = children->items[i];
-        if (window_is_fullscreen(child)) {
-            continue;
-        }
+        child->height_fraction = window->height_fraction;
+        child->titlebar_height = window->pending.titlebar_height;
+        child->fullscreen = window_is_fullscreen(window);
+        child->active = window == active_child;
+    }
 
-        double window_height = child->pending.titlebar_height;
-        if (child != active_child) {
-            child->pending.shaded = true;
-        } else {
-            window_height += available_content_height;
-            child->pending.shaded = false;
-        }
+    hwd_layout_column_prepare(&params, cache->children, children->length);
 
-        baseline_delta = next_baseline_delta;
-        next_baseline_delta = fabs(
-            column->pending.y + round(y_offset + window_height) + preview_baseline -
-            column->preview_anchor_y
+    int first = 0;
+    if (cache->valid) {
+        first = hwd_layout_column_resume_index(
+            &cache->params, prev_length, &params, children->length, first_changed
         );
-        if (column->pending.show_preview && !preview_inserted &&
-            next_baseline_delta > baseline_delta) {
+    }
 
-            double preview_height = preview_titlebar_height + available_content_height;
+    cache->length = children->length;
+    cache->valid = true;
 
-            column->pending.preview_target = window_get_previous_sibling(child);
-            column->pending.preview_box.x = column->pending.x;
-            column->pending.preview_box.y = column->pending.y + round(y_offset);
-            column->pending.preview_box.width = column->pending.width;
-            column->pending.preview_box.height = round(preview_height);
+    if (first == children->length) {
+        return;
+    }
 
-            preview_inserted = true;
+    hwd_layout_column(&params, cache->children, children->length, first);
+    cache->params = params;
 
-            y_offset += preview_height;
+    if (params.show_preview) {
+        column->pending.preview_target = NULL;
+        if (params.preview_index > 0) {
+            column->pending.preview_target = children->items[params.preview_index - 1];
         }
-
-        child->pending.x = column->pending.x;
-        child->pending.y = column->pending.y + round(y_offset);
-        child->pending.width = box.width;
-        child->pending.height = round(window_height);
-
-        y_offset += child->pending.height;
-
-        // TODO Make last visible child use remaining height of parent
+        column->pending.preview_box.x = params.preview_box.x;
+        column->pending.preview_box.y = params.preview_box.y;
+        column->pending.preview_box.width = params.preview_box.width;
+        column->pending.preview_box.height = params.preview_box.height;
     }
 
-    if (column->pending.show_preview && !preview_inserted) {
-        double preview_height = preview_titlebar_height + available_content_height;
+    // Only dirty windows that have moved, or that have changed position in the
+    // column since their theme may depend on their siblings.
+    for (int i = first; i < children->length; i++) {
+        struct hwd_window *window = children->items[i];
+        struct hwd_layout_column_child *child = &cache->children[i];
 
-        column->pending.preview_target = child;
-        column->pending.preview_box.x = column->pending.x;
-        column->pending.preview_box.y = column->pending.y + round(y_offset);
-        column->pending.preview_box.width = column->pending.width;
-        column->pending.preview_box.height = round(preview_height);
+        bool reordered = i >= prev_length || cache->windows[i] != window;
+        cache->windows[i] = window;
 
-        preview_inserted = true;
+        if (child->fullscreen) {
+            continue;
+        }
 
-        y_offset += preview_height;
-    }
+        struct hwd_window_state *state = &window->pending;
+        if (!reordered && state->x == box.x && state->y == child->y &&
+            state->width == box.width && state->height == child->height &&
+            state->shaded == child->shaded) {
+            continue;
+        }
+
+        state->x = box.x;
+        state->y = child->y;
+        state->width = box.width;
+        state->height = child->height;
+        state->shaded = child->shaded;
 
-    for (int i = 0; i < column->pending.children->length; i++) {
-        struct hwd_window *window = column->pending.children->items[i];
         window_set_dirty(window);
     }
 }
@@ -510,18 +427,16 @@ column_arrange(struct hwd_column *column) {
     if (column->dirty) {
         column->pending.dead = column->dead;
 
-        switch (column->layout) {
-        case L_SPLIT:
-            column_arrange_split(column);
-            break;
-        case L_STACKED:
-            column_arrange_stacked(column);
-            break;
-        default:
-            assert(false);
-            break;
-        }
+        column_arrange_children(column);
+    }
+
+    // Only columns that have changed, or that contain a window that has, need
+    // to have their windows visited.  Skipping the rest means a transaction
+    // doesn't have to touch every window on the workspace.
+    if (!column->dirty && !column->dirty_children) {
+        return;
     }
+    column->dirty_children = false;
 
     for (int i = 0; i < column->pending.children->length; i++) {
         struct hwd_window *window = column->pending.children->items[i];
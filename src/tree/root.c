@@ -18,6 +18,8 @@
 #include <wayland-util.h>
 
 #include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_ext_foreign_toplevel_list_v1.h>
+#include <wlr/types/wlr_foreign_toplevel_management_v1.h>
 #include <wlr/types/wlr_layer_shell_v1.h>
 #include <wlr/types/wlr_output.h>
 #include <wlr/types/wlr_output_layout.h>
@@ -53,7 +55,7 @@ struct hwd_pid_workspace {
 };
 
 static void
-root_validate(struct hwd_root *root);
+root_validate(struct hwd_root *root, bool full);
 
 static void
 root_init_scene(struct hwd_root *root) {
@@ -108,7 +110,26 @@ root_handle_transaction_before_commit(struct wl_listener *listener, void *data)
 #ifndef NDEBUG
     assert(root->focused_surface == root_get_focused_surface(root));
 
-    root_validate(root);
+    // Checking the whole tree is quadratic in the number of windows, so by
+    // default we only check dirty objects and fall back to a full sweep every
+    // few transactions to catch anything that was missed.
+    static int transactions_since_sweep = 0;
+    switch (debug.validate) {
+    case HWD_DEBUG_VALIDATE_INCREMENTAL:
+        transactions_since_sweep++;
+        if (debug.validate_sweep > 0 && transactions_since_sweep >= debug.validate_sweep) {
+            transactions_since_sweep = 0;
+            root_validate(root, true);
+        } else {
+            root_validate(root, false);
+        }
+        break;
+    case HWD_DEBUG_VALIDATE_FULL:
+        root_validate(root, true);
+        break;
+    case HWD_DEBUG_VALIDATE_NONE:
+        break;
+    }
 #endif
 }
 
@@ -153,6 +174,7 @@ root_handle_transaction_after_apply(struct wl_listener *listener, void *data) {
         root->orphaned_theme = NULL;
     }
 
+    root->scene_generation++;
     wl_signal_emit_mutable(&root->events.scene_changed, root);
 }
 
@@ -173,6 +195,8 @@ root_create(struct wl_display *display) {
 
     root->transaction_manager = hwd_transaction_manager_create();
     root->workspace_manager = hwd_workspace_manager_v1_create(display);
+    root->foreign_toplevel_manager = wlr_foreign_toplevel_manager_v1_create(display);
+    root->ext_foreign_toplevel_list = wlr_ext_foreign_toplevel_list_v1_create(display, 1);
 
     root->pending.outputs = create_list();
     root->committed.outputs = create_list();
@@ -603,9 +627,6 @@ column_validate(struct hwd_column *column) {
 
         // TODO validate that no columns on this output reference the window.
         assert(window->fullscreen || window->column != column || window->output == column->output);
-
-        // TODO should only be called once per window.
-        window_validate(window);
     }
 }
 
@@ -616,14 +637,15 @@ output_validate(struct hwd_output *output) {
     for (int i = 0; i < output->fullscreen_windows->length; i++) {
         struct hwd_window *window = output->fullscreen_windows->items[i];
         assert(window->fullscreen);
-
-        // TODO should only be called once per window.
-        window_validate(window);
     }
 }
 
+/**
+ * Checks that the tree is consistent.  If `full` is false then only objects
+ * that have been marked dirty since the last transaction are checked.
+ */
 static void
-root_validate(struct hwd_root *root) {
+root_validate(struct hwd_root *root, bool full) {
     assert(root != NULL);
 
     // Validate that there is at least one workspace.
@@ -647,20 +669,33 @@ root_validate(struct hwd_root *root) {
         // Validate floating windows.
         for (int j = 0; j < workspace->floating->length; j++) {
             struct hwd_window *window = workspace->floating->items[j];
-
-            // TODO should only be called once per window.
-            window_validate(window);
+            if (full || window->dirty) {
+                window_validate(window);
+            }
         }
 
+        // Validate tiling windows.  Fullscreen windows are always either
+        // floating or in a column so will be reached by one of these loops.
         for (int j = 0; j < workspace->columns->length; j++) {
             struct hwd_column *column = workspace->columns->items[j];
-            column_validate(column);
+            if (full || column->dirty) {
+                column_validate(column);
+            }
+
+            for (int k = 0; k < column->children->length; k++) {
+                struct hwd_window *window = column->children->items[k];
+                if (full || window->dirty) {
+                    window_validate(window);
+                }
+            }
         }
     }
 
     for (int i = 0; i < root->outputs->length; i++) {
         struct hwd_output *output = root->outputs->items[i];
-        output_validate(output);
+        if (full || output->dirty) {
+            output_validate(output);
+        }
     }
 }
 
@@ -8,6 +8,7 @@
 #include <assert.h>
 #include <errno.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -16,6 +17,7 @@
 
 #include <wlr/util/log.h>
 
+#include <hayward/latency.h>
 #include <hayward/profiler.h>
 #include <hayward/server.h>
 
@@ -66,6 +68,9 @@ transaction_progress(struct hwd_transaction_manager *transaction_manager) {
     hwd_profiler_mark(
         "transaction confirm", transaction_manager->begin_waiting_confirm, hwd_profiler_now()
     );
+    latency_record(
+        LATENCY_TRANSACTION_CONFIRM, transaction_manager->latency_begin_waiting_confirm
+    );
 
     wlr_log(WLR_DEBUG, "Applying transaction");
 
@@ -73,6 +78,7 @@ transaction_progress(struct hwd_transaction_manager *transaction_manager) {
 
     transaction_manager->phase = HWD_TRANSACTION_APPLY;
     hwd_timestamp begin_apply = hwd_profiler_now();
+    uint64_t latency_begin_apply = latency_now();
     wl_signal_emit_mutable(&transaction_manager->events.apply, NULL);
     hwd_profiler_mark("transaction apply", begin_apply, hwd_profiler_now());
 
@@ -80,12 +86,17 @@ transaction_progress(struct hwd_transaction_manager *transaction_manager) {
     hwd_timestamp begin_after_apply = hwd_profiler_now();
     wl_signal_emit_mutable(&transaction_manager->events.after_apply, NULL);
     hwd_profiler_mark("transaction after apply", begin_after_apply, hwd_profiler_now());
+    latency_record(LATENCY_TRANSACTION_APPLY, latency_begin_apply);
+
+    latency_record(LATENCY_KEY_TO_APPLY, transaction_manager->latency_committed_input);
+    transaction_manager->latency_committed_input = 0;
 
     hwd_profiler_mark("transaction", transaction_manager->begin_transaction, hwd_profiler_now());
 
     transaction_manager->phase = HWD_TRANSACTION_IDLE;
 
-    if (transaction_manager->queued && transaction_manager->idle == NULL) {
+    if (transaction_manager->queued && transaction_manager->depth == 0 &&
+        transaction_manager->idle == NULL) {
         transaction_manager->idle =
             wl_event_loop_add_idle(server.wl_event_loop, handle_commit, transaction_manager);
     }
@@ -97,9 +108,19 @@ handle_commit(void *data) {
 
     transaction_manager->idle = NULL;
 
-    assert(transaction_manager->depth == 0);
+    // A batch was opened after the commit was scheduled.  It will be
+    // rescheduled when the batch ends.
+    if (transaction_manager->depth > 0) {
+        return;
+    }
 
     transaction_manager->begin_transaction = hwd_profiler_now();
+    transaction_manager->latency_begin_transaction = latency_now();
+
+    // Changes made by input handled from here on will go into the next
+    // transaction.
+    transaction_manager->latency_committed_input = transaction_manager->latency_queued_input;
+    transaction_manager->latency_queued_input = 0;
 
     transaction_manager->phase = HWD_TRANSACTION_BEFORE_COMMIT;
     hwd_timestamp begin_before_commit = hwd_profiler_now();
@@ -115,9 +136,11 @@ handle_commit(void *data) {
     wl_signal_emit_mutable(&transaction_manager->events.commit, NULL);
 
     hwd_profiler_mark("transaction commit", begin_commit, hwd_profiler_now());
+    latency_record(LATENCY_TRANSACTION_COMMIT, transaction_manager->latency_begin_transaction);
 
     transaction_manager->phase = HWD_TRANSACTION_WAITING_CONFIRM;
     transaction_manager->begin_waiting_confirm = hwd_profiler_now();
+    transaction_manager->latency_begin_waiting_confirm = latency_now();
 
     transaction_manager->num_configures = transaction_manager->num_waiting;
 
@@ -165,7 +188,8 @@ hwd_transaction_manager_ensure_queued(struct hwd_transaction_manager *transactio
 
     transaction_manager->queued = true;
 
-    if (transaction_manager->phase == HWD_TRANSACTION_IDLE && transaction_manager->idle == NULL) {
+    if (transaction_manager->phase == HWD_TRANSACTION_IDLE && transaction_manager->depth == 0 &&
+        transaction_manager->idle == NULL) {
         transaction_manager->idle =
             wl_event_loop_add_idle(server.wl_event_loop, handle_commit, transaction_manager);
     }
@@ -194,3 +218,37 @@ hwd_transaction_manager_release_commit_lock(struct hwd_transaction_manager *tran
 
     transaction_progress(transaction_manager);
 }
+
+void
+hwd_transaction_manager_begin_batch(struct hwd_transaction_manager *transaction_manager) {
+    assert(transaction_manager != NULL);
+
+    transaction_manager->depth++;
+}
+
+void
+hwd_transaction_manager_end_batch(struct hwd_transaction_manager *transaction_manager) {
+    assert(transaction_manager != NULL);
+    assert(transaction_manager->depth > 0);
+
+    transaction_manager->depth--;
+
+    if (transaction_manager->depth == 0 && transaction_manager->queued) {
+        hwd_transaction_manager_ensure_queued(transaction_manager);
+    }
+}
+
+void
+hwd_transaction_manager_track_input(
+    struct hwd_transaction_manager *transaction_manager, uint64_t event_time_usec
+) {
+    assert(transaction_manager != NULL);
+
+    if (!transaction_manager->queued || event_time_usec == 0) {
+        return;
+    }
+    if (transaction_manager->latency_queued_input == 0 ||
+        event_time_usec < transaction_manager->latency_queued_input) {
+        transaction_manager->latency_queued_input = event_time_usec;
+    }
+}
@@ -6,7 +6,6 @@
 #include "hayward/tree/window.h"
 
 #include <assert.h>
-#include <limits.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
@@ -16,8 +15,10 @@
 #include <wayland-server-core.h>
 #include <wayland-util.h>
 
-#include <wlr/render/wlr_texture.h>
 #include <wlr/types/wlr_compositor.h>
+#include <wlr/types/wlr_ext_foreign_toplevel_list_v1.h>
+#include <wlr/types/wlr_ext_image_capture_source_v1.h>
+#include <wlr/types/wlr_foreign_toplevel_management_v1.h>
 #include <wlr/types/wlr_output_layout.h>
 #include <wlr/types/wlr_scene.h>
 #include <wlr/util/addon.h>
@@ -27,6 +28,7 @@
 #include <hayward/config.h>
 #include <hayward/input/input_manager.h>
 #include <hayward/input/seat.h>
+#include <hayward/layout.h>
 #include <hayward/list.h>
 #include <hayward/profiler.h>
 #include <hayward/scene/colours.h>
@@ -50,12 +52,28 @@ static const struct wlr_addon_interface scene_tree_marker_interface = {
     .name = "hwd_window", .destroy = scene_tree_marker_destroy
 };
 
+struct window_freeze_content_state {
+    struct wlr_scene_tree *tree;
+
+    // The next existing node in `tree` that can be reused.
+    struct wl_list *link;
+};
+
 static void
 window_freeze_content_iterator(struct wlr_scene_buffer *buffer, int sx, int sy, void *data) {
-    struct wlr_scene_tree *tree = data;
+    struct window_freeze_content_state *state = data;
 
-    struct wlr_scene_buffer *sbuf = wlr_scene_buffer_create(tree, NULL);
-    assert(sbuf != NULL);
+    struct wlr_scene_buffer *sbuf;
+    if (state->link != &state->tree->children) {
+        struct wlr_scene_node *node = wl_container_of(state->link, node, link);
+        state->link = state->link->next;
+
+        sbuf = wlr_scene_buffer_from_node(node);
+        wlr_scene_node_set_enabled(node, true);
+    } else {
+        sbuf = wlr_scene_buffer_create(state->tree, NULL);
+        assert(sbuf != NULL);
+    }
 
     wlr_scene_buffer_set_dest_size(sbuf, buffer->dst_width, buffer->dst_height);
     wlr_scene_buffer_set_opaque_region(sbuf, &buffer->opaque_region);
@@ -65,34 +83,60 @@ window_freeze_content_iterator(struct wlr_scene_buffer *buffer, int sx, int sy,
     wlr_scene_buffer_set_buffer(sbuf, buffer->buffer);
 }
 
+/**
+ * Disables and releases the buffers held by saved content nodes, starting from
+ * `link`.  The nodes themselves are kept so that they can be reused by the next
+ * freeze.
+ */
 static void
-window_freeze_content(struct hwd_window *window) {
-    assert(window->layers.saved_content_tree == NULL);
+window_release_saved_content(struct hwd_window *window, struct wl_list *link) {
+    struct wlr_scene_tree *tree = window->layers.saved_content_tree;
 
-    window->layers.saved_content_tree = wlr_scene_tree_create(window->scene_tree);
-    assert(window->layers.saved_content_tree != NULL);
+    while (link != &tree->children) {
+        struct wlr_scene_node *node = wl_container_of(link, node, link);
+        link = link->next;
 
-    // Enable and disable the saved surface tree like so to atomitaclly update
-    // the tree. This will prevent over damaging or other weirdness.
-    wlr_scene_node_set_enabled(&window->layers.saved_content_tree->node, false);
+        wlr_scene_node_set_enabled(node, false);
+        wlr_scene_buffer_set_buffer(wlr_scene_buffer_from_node(node), NULL);
+    }
+}
 
+static void
+window_freeze_content(struct hwd_window *window) {
+    struct wlr_scene_tree *tree = window->layers.saved_content_tree;
+    assert(!tree->node.enabled);
+
+    // The saved content tree is kept between configures and its nodes are
+    // updated in place, so that interactive resizes don't create and destroy
+    // a scene node for every surface at pointer rate.
+    struct window_freeze_content_state state = {
+        .tree = tree,
+        .link = tree->children.next,
+    };
     wlr_scene_node_for_each_buffer(
-        &window->layers.content_tree->node, window_freeze_content_iterator,
-        window->layers.saved_content_tree
+        &window->layers.content_tree->node, window_freeze_content_iterator, &state
     );
+    window_release_saved_content(window, state.link);
+
+    // The saved tree is a sibling of the content tree and stays at the origin.
+    // Buffer positions from the iterator already include the content tree's
+    // own offset.
 
+    // Enable and disable the saved surface tree like so to atomitaclly update
+    // the tree. This will prevent over damaging or other weirdness.
     wlr_scene_node_set_enabled(&window->layers.content_tree->node, false);
-    wlr_scene_node_set_enabled(&window->layers.saved_content_tree->node, true);
+    wlr_scene_node_set_enabled(&tree->node, true);
 }
 
 static void
 window_unfreeze_content(struct hwd_window *window) {
-    if (window->layers.saved_content_tree == NULL) {
+    struct wlr_scene_tree *tree = window->layers.saved_content_tree;
+    if (!tree->node.enabled) {
         return;
     }
 
-    wlr_scene_node_destroy(&window->layers.saved_content_tree->node);
-    window->layers.saved_content_tree = NULL;
+    wlr_scene_node_set_enabled(&tree->node, false);
+    window_release_saved_content(window, tree->children.next);
 
     wlr_scene_node_set_enabled(&window->layers.content_tree->node, true);
 }
@@ -125,6 +169,10 @@ window_init_scene(struct hwd_window *window) {
     window->layers.content_tree = wlr_scene_tree_create(scene_tree);
     assert(window->layers.content_tree != NULL);
 
+    window->layers.saved_content_tree = wlr_scene_tree_create(scene_tree);
+    assert(window->layers.saved_content_tree != NULL);
+    wlr_scene_node_set_enabled(&window->layers.saved_content_tree->node, false);
+
     window->layers.popup_tree = wlr_scene_tree_create(scene_tree);
 }
 
@@ -213,12 +261,16 @@ window_destroy_scene(struct hwd_window *window) {
     wlr_addon_finish(&window->scene_tree_marker);
     wlr_scene_node_destroy(&window->scene_tree->node);
 
+    if (window->image_capture_scene != NULL) {
+        // Also destroys the capture source.
+        wlr_scene_node_destroy(&window->image_capture_scene->tree.node);
+        window->image_capture_scene = NULL;
+        window->image_capture_source = NULL;
+    }
+
     free(window->title);
-    wlr_texture_destroy(window->title_focused);
-    wlr_texture_destroy(window->title_focused_inactive);
-    wlr_texture_destroy(window->title_unfocused);
-    wlr_texture_destroy(window->title_urgent);
-    wlr_texture_destroy(window->title_focused_tab_title);
+    free(window->pending_title);
+    free(window->app_id);
 }
 
 void
@@ -256,6 +308,159 @@ window_handle_parent_begin_destroy(struct wl_listener *listener, void *data) {
     wl_list_remove(&window->parent_begin_destroy.link);
 }
 
+static void
+window_handle_foreign_toplevel_request_activate(struct wl_listener *listener, void *data) {
+    struct hwd_window *window =
+        wl_container_of(listener, window, foreign_toplevel_request_activate);
+
+    if (!window_is_alive(window)) {
+        return;
+    }
+
+    root_set_focused_window(window->root, window);
+}
+
+static void
+window_handle_foreign_toplevel_request_close(struct wl_listener *listener, void *data) {
+    struct hwd_window *window = wl_container_of(listener, window, foreign_toplevel_request_close);
+
+    if (!window_is_alive(window)) {
+        return;
+    }
+
+    window_close(window);
+}
+
+static void
+window_handle_foreign_toplevel_request_fullscreen(struct wl_listener *listener, void *data) {
+    struct hwd_window *window =
+        wl_container_of(listener, window, foreign_toplevel_request_fullscreen);
+    struct wlr_foreign_toplevel_handle_v1_fullscreen_event *event = data;
+
+    if (!window_is_alive(window)) {
+        return;
+    }
+
+    if (event->fullscreen) {
+        window_fullscreen(window);
+    } else {
+        window_unfullscreen(window);
+    }
+}
+
+static void
+window_destroy_foreign_toplevel(struct hwd_window *window) {
+    if (window->ext_foreign_toplevel != NULL) {
+        wlr_ext_foreign_toplevel_handle_v1_destroy(window->ext_foreign_toplevel);
+        window->ext_foreign_toplevel = NULL;
+    }
+
+    if (window->foreign_toplevel == NULL) {
+        return;
+    }
+
+    wl_list_remove(&window->foreign_toplevel_request_activate.link);
+    wl_list_remove(&window->foreign_toplevel_request_close.link);
+    wl_list_remove(&window->foreign_toplevel_request_fullscreen.link);
+    wlr_foreign_toplevel_handle_v1_destroy(window->foreign_toplevel);
+    window->foreign_toplevel = NULL;
+}
+
+static bool
+window_foreign_toplevel_string_changed(const char *sent, const char *value) {
+    return sent == NULL || strcmp(sent, value) != 0;
+}
+
+/**
+ * Brings the window's foreign toplevel handles up to date with the state being
+ * committed.  Only fields that have changed are sent, and wlroots follows them
+ * with a single `done` event, so clients see at most one update per window per
+ * transaction however often the window changed in between.
+ */
+static void
+window_update_foreign_toplevel(struct hwd_window *window) {
+    if (window->dead) {
+        window_destroy_foreign_toplevel(window);
+        return;
+    }
+
+    if (window->foreign_toplevel == NULL) {
+        window->foreign_toplevel =
+            wlr_foreign_toplevel_handle_v1_create(window->root->foreign_toplevel_manager);
+        assert(window->foreign_toplevel != NULL);
+
+        window->foreign_toplevel_request_activate.notify =
+            window_handle_foreign_toplevel_request_activate;
+        wl_signal_add(
+            &window->foreign_toplevel->events.request_activate,
+            &window->foreign_toplevel_request_activate
+        );
+        window->foreign_toplevel_request_close.notify =
+            window_handle_foreign_toplevel_request_close;
+        wl_signal_add(
+            &window->foreign_toplevel->events.request_close,
+            &window->foreign_toplevel_request_close
+        );
+        window->foreign_toplevel_request_fullscreen.notify =
+            window_handle_foreign_toplevel_request_fullscreen;
+        wl_signal_add(
+            &window->foreign_toplevel->events.request_fullscreen,
+            &window->foreign_toplevel_request_fullscreen
+        );
+    }
+
+    struct wlr_foreign_toplevel_handle_v1 *handle = window->foreign_toplevel;
+
+    const char *title = window->title ? window->title : "";
+    const char *app_id = window->app_id ? window->app_id : "";
+
+    struct wlr_ext_foreign_toplevel_handle_v1_state ext_state = {
+        .title = title,
+        .app_id = app_id,
+    };
+    struct wlr_ext_foreign_toplevel_handle_v1 *ext_handle = window->ext_foreign_toplevel;
+    if (ext_handle == NULL) {
+        ext_handle = wlr_ext_foreign_toplevel_handle_v1_create(
+            window->root->ext_foreign_toplevel_list, &ext_state
+        );
+        assert(ext_handle != NULL);
+        ext_handle->data = window;
+        window->ext_foreign_toplevel = ext_handle;
+    } else if (window_foreign_toplevel_string_changed(ext_handle->title, title) ||
+               window_foreign_toplevel_string_changed(ext_handle->app_id, app_id)) {
+        wlr_ext_foreign_toplevel_handle_v1_update_state(ext_handle, &ext_state);
+    }
+
+    if (window_foreign_toplevel_string_changed(handle->title, title)) {
+        wlr_foreign_toplevel_handle_v1_set_title(handle, title);
+    }
+    if (window_foreign_toplevel_string_changed(handle->app_id, app_id)) {
+        wlr_foreign_toplevel_handle_v1_set_app_id(handle, app_id);
+    }
+
+    // wlroots ignores state, output and parent updates that don't change
+    // anything.
+    wlr_foreign_toplevel_handle_v1_set_activated(handle, window->pending.focused);
+    wlr_foreign_toplevel_handle_v1_set_fullscreen(handle, window->pending.fullscreen);
+    wlr_foreign_toplevel_handle_v1_set_parent(
+        handle, window->parent != NULL ? window->parent->foreign_toplevel : NULL
+    );
+
+    struct wlr_output *wlr_output = NULL;
+    if (window->output != NULL && !window->output->dead) {
+        wlr_output = window->output->wlr_output;
+    }
+    struct wlr_foreign_toplevel_handle_v1_output *entered, *tmp;
+    wl_list_for_each_safe(entered, tmp, &handle->outputs, link) {
+        if (entered->output != wlr_output) {
+            wlr_foreign_toplevel_handle_v1_output_leave(handle, entered->output);
+        }
+    }
+    if (wlr_output != NULL) {
+        wlr_foreign_toplevel_handle_v1_output_enter(handle, wlr_output);
+    }
+}
+
 static void
 window_handle_transaction_commit(struct wl_listener *listener, void *data) {
     struct hwd_window *window = wl_container_of(listener, window, transaction_commit);
@@ -269,6 +474,8 @@ window_handle_transaction_commit(struct wl_listener *listener, void *data) {
 
     wl_signal_emit_mutable(&window->events.commit, window);
 
+    window_update_foreign_toplevel(window);
+
     memcpy(&window->committed, &window->pending, sizeof(struct hwd_window_state));
 }
 
@@ -378,6 +585,11 @@ window_begin_destroy(struct hwd_window *window) {
         window->urgent_timer = NULL;
     }
 
+    if (window->title_timer) {
+        wl_event_source_remove(window->title_timer);
+        window->title_timer = NULL;
+    }
+
     if (window->parent != NULL) {
         window->parent = NULL;
         wl_list_remove(&window->parent_begin_destroy.link);
@@ -402,6 +614,10 @@ window_set_dirty(struct hwd_window *window) {
     window->dirty = true;
     wl_signal_add(&transaction_manager->events.commit, &window->transaction_commit);
     hwd_transaction_manager_ensure_queued(transaction_manager);
+
+    if (window->column != NULL) {
+        window->column->dirty_children = true;
+    }
 }
 
 void
@@ -561,6 +777,18 @@ window_set_moving(struct hwd_window *window, bool moving) {
     window_set_dirty(window);
 }
 
+static struct hwd_layout_borders
+window_get_layout_borders(struct hwd_window_state *state) {
+    struct hwd_layout_borders borders = {
+        .titlebar_height = state->titlebar_height,
+        .left = state->border_left,
+        .right = state->border_right,
+        .top = state->border_top,
+        .bottom = state->border_bottom,
+    };
+    return borders;
+}
+
 void
 window_arrange(struct hwd_window *window) {
     HWD_PROFILER_TRACE();
@@ -598,29 +826,37 @@ window_arrange(struct hwd_window *window) {
                 // parent.
                 struct hwd_output *output = window_get_output(window);
 
-                double center_x = output->pending.x + (window->floating_x * output->pending.width);
-                double center_y = output->pending.y + (window->floating_y * output->pending.height);
-
-                state->x = center_x - (window->floating_width / 2) - state->border_left;
-                state->y = center_y - (window->floating_height / 2) - state->titlebar_height -
-                    state->border_top;
-                state->width = window->floating_width + state->border_left + state->border_right;
-                state->height = window->floating_height + state->titlebar_height +
-                    state->border_top + state->border_bottom;
+                struct hwd_layout_box output_box = {
+                    .x = output->pending.x,
+                    .y = output->pending.y,
+                    .width = output->pending.width,
+                    .height = output->pending.height,
+                };
+                struct hwd_layout_borders borders = window_get_layout_borders(state);
+                struct hwd_layout_box box;
+                hwd_layout_window_floating(
+                    &output_box, window->floating_x, window->floating_y, window->floating_width,
+                    window->floating_height, &borders, &box
+                );
+
+                state->x = box.x;
+                state->y = box.y;
+                state->width = box.width;
+                state->height = box.height;
             }
         }
 
-        state->content_x = state->x + state->border_left;
-        state->content_y = state->y + state->titlebar_height + state->border_top;
-        state->content_width = state->width - state->border_left - state->border_right;
-        if (state->content_width < 0) {
-            state->content_width = 0;
-        }
-        state->content_height =
-            state->height - state->titlebar_height - state->border_top - state->border_bottom;
-        if (state->content_height < 0) {
-            state->content_height = 0;
-        }
+        struct hwd_layout_box box = {
+            .x = state->x, .y = state->y, .width = state->width, .height = state->height
+        };
+        struct hwd_layout_borders borders = window_get_layout_borders(state);
+        struct hwd_layout_box content;
+        hwd_layout_window_content(&box, &borders, &content);
+
+        state->content_x = content.x;
+        state->content_y = content.y;
+        state->content_width = content.width;
+        state->content_height = content.height;
     }
 }
 
@@ -705,13 +941,68 @@ window_end_mouse_operation(struct hwd_window *window) {
     wl_list_for_each(seat, &server.input->seats, link) { seatop_unref(seat, window); }
 }
 
+static bool
+window_apply_title(struct hwd_window *window, const char *title) {
+    if (window->title != NULL && strcmp(window->title, title) == 0) {
+        return false;
+    }
+
+    free(window->title);
+    window->title = strdup(title);
+
+    window_set_dirty(window);
+    return true;
+}
+
+static int
+window_handle_title_timer(void *data) {
+    struct hwd_window *window = data;
+
+    char *title = window->pending_title;
+    window->pending_title = NULL;
+
+    // Keep throttling for as long as the title keeps changing.
+    if (title != NULL && window_apply_title(window, title) && config->title_update_interval > 0) {
+        wl_event_source_timer_update(window->title_timer, config->title_update_interval);
+    } else {
+        wl_event_source_remove(window->title_timer);
+        window->title_timer = NULL;
+    }
+
+    free(title);
+    return 0;
+}
+
 void
 window_set_title(struct hwd_window *window, const char *title) {
     assert(window != NULL);
     assert(title != NULL);
 
-    free(window->title);
-    window->title = strdup(title);
+    if (window->title_timer != NULL) {
+        free(window->pending_title);
+        window->pending_title = strdup(title);
+        return;
+    }
+
+    if (window_apply_title(window, title) && config->title_update_interval > 0) {
+        window->title_timer =
+            wl_event_loop_add_timer(server.wl_event_loop, window_handle_title_timer, window);
+        assert(window->title_timer != NULL);
+        wl_event_source_timer_update(window->title_timer, config->title_update_interval);
+    }
+}
+
+void
+window_set_app_id(struct hwd_window *window, const char *app_id) {
+    assert(window != NULL);
+
+    if ((window->app_id == NULL && app_id == NULL) ||
+        (window->app_id != NULL && app_id != NULL && strcmp(window->app_id, app_id) == 0)) {
+        return;
+    }
+
+    free(window->app_id);
+    window->app_id = app_id != NULL ? strdup(app_id) : NULL;
 
     window_set_dirty(window);
 }
@@ -1033,52 +1324,31 @@ void
 floating_calculate_constraints(
     struct hwd_window *window, int *min_width, int *max_width, int *min_height, int *max_height
 ) {
-    if (config->floating_minimum_width == -1) { // no minimum
-        *min_width = 0;
-    } else if (config->floating_minimum_width == 0) { // automatic
-        *min_width = 75;
-    } else {
-        *min_width = config->floating_minimum_width;
-    }
-    if (window->minimum_width != 0) {
-        *min_width = fmax(*min_width, window->minimum_width);
-    }
-
-    if (config->floating_minimum_height == -1) { // no minimum
-        *min_height = 0;
-    } else if (config->floating_minimum_height == 0) { // automatic
-        *min_height = 50;
-    } else {
-        *min_height = config->floating_minimum_height;
-    }
-    if (window->minimum_height != 0) {
-        *min_height = fmax(*min_height, window->minimum_height);
-    }
+    struct hwd_layout_size_limits config_limits = {
+        .min_width = config->floating_minimum_width,
+        .max_width = config->floating_maximum_width,
+        .min_height = config->floating_minimum_height,
+        .max_height = config->floating_maximum_height,
+    };
+    struct hwd_layout_size_limits window_limits = {
+        .min_width = window->minimum_width,
+        .max_width = window->maximum_width,
+        .min_height = window->minimum_height,
+        .max_height = window->maximum_height,
+    };
 
     struct wlr_box box;
     wlr_output_layout_get_box(window->root->output_layout, NULL, &box);
 
-    if (config->floating_maximum_width == -1) { // no maximum
-        *max_width = INT_MAX;
-    } else if (config->floating_maximum_width == 0) { // automatic
-        *max_width = box.width;
-    } else {
-        *max_width = config->floating_maximum_width;
-    }
-    if (window->maximum_width != 0) {
-        *max_width = fmin(*max_width, window->maximum_width);
-    }
+    struct hwd_layout_size_limits constraints;
+    hwd_layout_floating_constraints(
+        &config_limits, &window_limits, box.width, box.height, &constraints
+    );
 
-    if (config->floating_maximum_height == -1) { // no maximum
-        *max_height = INT_MAX;
-    } else if (config->floating_maximum_height == 0) { // automatic
-        *max_height = box.height;
-    } else {
-        *max_height = config->floating_maximum_height;
-    }
-    if (window->maximum_height != 0) {
-        *max_height = fmin(*max_height, window->maximum_height);
-    }
+    *min_width = constraints.min_width;
+    *max_width = constraints.max_width;
+    *min_height = constraints.min_height;
+    *max_height = constraints.max_height;
 }
 
 void
@@ -1209,3 +1479,39 @@ window_for_scene_node(struct wlr_scene_node *node) {
 
     return window;
 }
+
+struct wlr_ext_image_capture_source_v1 *
+window_get_image_capture_source(struct hwd_window *window) {
+    assert(window != NULL);
+
+    if (window->image_capture_source != NULL) {
+        return window->image_capture_source;
+    }
+
+    if (!window_is_alive(window) || window->view == NULL || window->view->surface == NULL) {
+        return NULL;
+    }
+
+    if (window->image_capture_scene == NULL) {
+        window->image_capture_scene = wlr_scene_create();
+        assert(window->image_capture_scene != NULL);
+
+        struct wlr_scene_tree *tree = wlr_scene_subsurface_tree_create(
+            &window->image_capture_scene->tree, window->view->surface
+        );
+        assert(tree != NULL);
+    }
+
+    // The source renders the scene through its own scene output, so captures
+    // get the same damage tracking as real outputs and no frames are produced
+    // while the window is unchanged.
+    window->image_capture_source = wlr_ext_image_capture_source_v1_create_with_scene_node(
+        &window->image_capture_scene->tree.node, server.wl_event_loop, server.allocator,
+        server.renderer
+    );
+    if (window->image_capture_source == NULL) {
+        wlr_log(WLR_ERROR, "Unable to create image capture source for window");
+    }
+
+    return window->image_capture_source;
+}
@@ -7,7 +7,6 @@
 
 #include <assert.h>
 #include <ctype.h>
-#include <math.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdlib.h>
@@ -23,6 +22,7 @@
 
 #include <hayward/desktop/hwd_workspace_management_v1.h>
 #include <hayward/globals/root.h>
+#include <hayward/layout.h>
 #include <hayward/list.h>
 #include <hayward/profiler.h>
 #include <hayward/scene/nineslice.h>
@@ -350,6 +350,7 @@ workspace_destroy(struct hwd_workspace *workspace) {
 
     list_free(workspace->columns);
     list_free(workspace->floating);
+    free(workspace->tiling_layout);
 
     free(workspace->name);
     list_free(workspace->pending.floating);
@@ -459,94 +460,62 @@ arrange_tiling(struct hwd_workspace *workspace) {
         return;
     }
 
+    if (workspace->tiling_layout_capacity < columns->length) {
+        workspace->tiling_layout_capacity = columns->length * 2;
+        workspace->tiling_layout = realloc(
+            workspace->tiling_layout,
+            sizeof(struct hwd_layout_tiling_column) * workspace->tiling_layout_capacity
+        );
+        assert(workspace->tiling_layout != NULL);
+    }
+    struct hwd_layout_tiling_column *layout_columns = workspace->tiling_layout;
+
     for (int i = 0; i < root->outputs->length; ++i) {
         struct hwd_output *output = root->outputs->items[i];
 
         struct wlr_box box;
         output_get_usable_area(output, &box);
 
-        // Count the number of new columns we are resizing, and how much space
-        // is currently occupied.
-        int new_columns = 0;
+        struct hwd_layout_box area = {
+            .x = box.x, .y = box.y, .width = box.width, .height = box.height
+        };
+
         int total_columns = 0;
-        double current_width_fraction = 0;
         for (int j = 0; j < columns->length; ++j) {
             struct hwd_column *column = columns->items[j];
             if (column->output != output) {
                 continue;
             }
 
-            current_width_fraction += column->width_fraction;
-            if (column->width_fraction <= 0) {
-                new_columns += 1;
-            }
+            layout_columns[total_columns].width_fraction = column->width_fraction;
             total_columns += 1;
         }
 
-        // Scan for first column, last column, and total width fraction for this
-        // output.
-        struct hwd_column *first_column = NULL;
-        struct hwd_column *last_column = NULL;
-        double total_width_fraction = 0;
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            if (column->output != output) {
-                continue;
-            }
-
-            if (first_column == NULL) {
-                first_column = column;
-            }
-            last_column = column;
-
-            if (column->width_fraction <= 0) {
-                if (current_width_fraction <= 0) {
-                    column->width_fraction = 1.0;
-                } else if (total_columns > new_columns) {
-                    column->width_fraction = current_width_fraction / (total_columns - new_columns);
-                } else {
-                    column->width_fraction = current_width_fraction;
-                }
-            }
-            total_width_fraction += column->width_fraction;
-        }
-
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            column->pending.is_first_child = column == first_column;
-            column->pending.is_last_child = column == last_column;
-        }
-
-        // Normalize width fractions so the sum is 1.0.
-        for (int j = 0; j < columns->length; ++j) {
-            struct hwd_column *column = columns->items[j];
-            if (column->output != output) {
-                continue;
-            }
-            column->width_fraction /= total_width_fraction;
-        }
+        hwd_layout_tiling(&area, gap, layout_columns, total_columns);
 
         double columns_total_width = box.width - gap * (total_columns - 1);
 
-        // Resize columns.
-        double column_x = box.x;
+        int column_index = 0;
         for (int j = 0; j < columns->length; ++j) {
             struct hwd_column *column = columns->items[j];
             if (column->output != output) {
                 continue;
             }
 
+            struct hwd_layout_tiling_column *layout_column = &layout_columns[column_index];
+
+            column->width_fraction = layout_column->width_fraction;
             column->child_total_width = columns_total_width;
-            column->pending.x = column_x;
-            column->pending.y = box.y;
-            column->pending.width = round(column->width_fraction * columns_total_width);
-            column->pending.height = box.height;
-            column_x += column->pending.width + gap;
-
-            // Make last child use remaining width of parent.
-            if (j == total_columns - 1) {
-                column->pending.width = box.x + box.width - column->pending.x;
-            }
+
+            column->pending.is_first_child = column_index == 0;
+            column->pending.is_last_child = column_index == total_columns - 1;
+
+            column->pending.x = layout_column->box.x;
+            column->pending.y = layout_column->box.y;
+            column->pending.width = layout_column->box.width;
+            column->pending.height = layout_column->box.height;
+
+            column_index += 1;
         }
     }
 
@@ -0,0 +1,270 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include "hayward/variables.h"
+
+#include <assert.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HWD_VARIABLES_INITIAL_SLOTS 16
+
+// FNV-1a, which can be extended one byte at a time to hash every prefix of a
+// string in a single pass.
+#define HWD_VARIABLES_HASH_INIT 2166136261u
+
+static uint32_t
+hwd_variables_hash_step(uint32_t hash, char c) {
+    return (hash ^ (unsigned char)c) * 16777619u;
+}
+
+static uint32_t
+hwd_variables_hash_finish(uint32_t hash) {
+    // murmur3 finalizer, to spread names that differ only in their last
+    // character across the table.
+    hash ^= hash >> 16;
+    hash *= 0x85ebca6bu;
+    hash ^= hash >> 13;
+    hash *= 0xc2b2ae35u;
+    hash ^= hash >> 16;
+    return hash;
+}
+
+static uint32_t
+hwd_variables_hash(const char *name, size_t name_length) {
+    uint32_t hash = HWD_VARIABLES_HASH_INIT;
+    for (size_t i = 0; i < name_length; i++) {
+        hash = hwd_variables_hash_step(hash, name[i]);
+    }
+    return hwd_variables_hash_finish(hash);
+}
+
+static struct hwd_variables_slot *
+hwd_variables_find_slot(
+    const struct hwd_variables *variables, uint32_t hash, const char *name, size_t name_length
+) {
+    uint32_t mask = variables->slots_capacity - 1;
+
+    // The table is never more than half full, so this always terminates.
+    for (uint32_t i = hash & mask;; i = (i + 1) & mask) {
+        struct hwd_variables_slot *slot = &variables->slots[i];
+        if (slot->name == NULL) {
+            return slot;
+        }
+        if (slot->hash == hash && slot->name_length == name_length &&
+            memcmp(slot->name, name, name_length) == 0) {
+            return slot;
+        }
+    }
+}
+
+static void
+hwd_variables_grow_slots(struct hwd_variables *variables) {
+    struct hwd_variables_slot *old_slots = variables->slots;
+    int old_capacity = variables->slots_capacity;
+
+    variables->slots_capacity *= 2;
+    variables->slots = calloc(variables->slots_capacity, sizeof(struct hwd_variables_slot));
+    assert(variables->slots != NULL);
+
+    // Names in the old table are distinct, so we only need to look for the
+    // first empty slot.
+    uint32_t mask = variables->slots_capacity - 1;
+    for (int i = 0; i < old_capacity; i++) {
+        struct hwd_variables_slot *old_slot = &old_slots[i];
+        if (old_slot->name == NULL) {
+            continue;
+        }
+
+        uint32_t j = old_slot->hash & mask;
+        while (variables->slots[j].name != NULL) {
+            j = (j + 1) & mask;
+        }
+        variables->slots[j] = *old_slot;
+    }
+
+    free(old_slots);
+}
+
+static void
+hwd_variables_add_name_length(struct hwd_variables *variables, size_t name_length) {
+    if (name_length > variables->max_name_length) {
+        variables->name_lengths =
+            realloc(variables->name_lengths, sizeof(int) * (name_length + 1));
+        assert(variables->name_lengths != NULL);
+        for (size_t i = variables->max_name_length + 1; i <= name_length; i++) {
+            variables->name_lengths[i] = 0;
+        }
+
+        variables->prefix_hashes =
+            realloc(variables->prefix_hashes, sizeof(uint32_t) * (name_length + 1));
+        assert(variables->prefix_hashes != NULL);
+
+        variables->max_name_length = name_length;
+    }
+    variables->name_lengths[name_length]++;
+}
+
+struct hwd_variables *
+hwd_variables_create(void) {
+    struct hwd_variables *variables = calloc(1, sizeof(struct hwd_variables));
+    assert(variables != NULL);
+
+    variables->slots_capacity = HWD_VARIABLES_INITIAL_SLOTS;
+    variables->slots = calloc(variables->slots_capacity, sizeof(struct hwd_variables_slot));
+    assert(variables->slots != NULL);
+
+    variables->name_lengths = calloc(1, sizeof(int));
+    assert(variables->name_lengths != NULL);
+    variables->prefix_hashes = calloc(1, sizeof(uint32_t));
+    assert(variables->prefix_hashes != NULL);
+
+    return variables;
+}
+
+void
+hwd_variables_destroy(struct hwd_variables *variables) {
+    if (variables == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < variables->slots_capacity; i++) {
+        free(variables->slots[i].name);
+        free(variables->slots[i].value);
+    }
+    free(variables->slots);
+    free(variables->name_lengths);
+    free(variables->prefix_hashes);
+    free(variables);
+}
+
+void
+hwd_variables_set(struct hwd_variables *variables, const char *name, const char *value) {
+    size_t name_length = strlen(name);
+    uint32_t hash = hwd_variables_hash(name, name_length);
+
+    char *value_copy = strdup(value);
+    assert(value_copy != NULL);
+
+    struct hwd_variables_slot *slot =
+        hwd_variables_find_slot(variables, hash, name, name_length);
+    if (slot->name != NULL) {
+        free(slot->value);
+        slot->value = value_copy;
+        slot->value_length = strlen(value_copy);
+        return;
+    }
+
+    slot->name = strdup(name);
+    assert(slot->name != NULL);
+    slot->name_length = name_length;
+    slot->hash = hash;
+    slot->value = value_copy;
+    slot->value_length = strlen(value_copy);
+    variables->length++;
+
+    hwd_variables_add_name_length(variables, name_length);
+
+    if (variables->length * 2 >= variables->slots_capacity) {
+        hwd_variables_grow_slots(variables);
+    }
+}
+
+/**
+ * Returns the variable with the longest name that is a prefix of `str`, or
+ * NULL if there is none.
+ */
+static const struct hwd_variables_slot *
+hwd_variables_match(struct hwd_variables *variables, const char *str) {
+    uint32_t hash = HWD_VARIABLES_HASH_INIT;
+    size_t length = 0;
+    while (length < variables->max_name_length && str[length] != '\0') {
+        hash = hwd_variables_hash_step(hash, str[length]);
+        length++;
+        variables->prefix_hashes[length] = hash;
+    }
+
+    for (; length > 0; length--) {
+        if (variables->name_lengths[length] == 0) {
+            continue;
+        }
+
+        uint32_t prefix_hash = hwd_variables_hash_finish(variables->prefix_hashes[length]);
+        const struct hwd_variables_slot *slot =
+            hwd_variables_find_slot(variables, prefix_hash, str, length);
+        if (slot->name != NULL) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+struct hwd_variables_buffer {
+    char *data;
+    size_t length;
+    size_t capacity;
+};
+
+static void
+hwd_variables_buffer_append(struct hwd_variables_buffer *buffer, const char *str, size_t length) {
+    if (buffer->length + length + 1 > buffer->capacity) {
+        while (buffer->length + length + 1 > buffer->capacity) {
+            buffer->capacity *= 2;
+        }
+        buffer->data = realloc(buffer->data, buffer->capacity);
+        assert(buffer->data != NULL);
+    }
+    memcpy(&buffer->data[buffer->length], str, length);
+    buffer->length += length;
+}
+
+char *
+hwd_variables_expand(struct hwd_variables *variables, const char *str) {
+    struct hwd_variables_buffer buffer = {0};
+    buffer.capacity = strlen(str) + 1;
+    buffer.data = malloc(buffer.capacity);
+    assert(buffer.data != NULL);
+
+    const char *next = str;
+    const char *find;
+    while ((find = strchr(next, '$'))) {
+        hwd_variables_buffer_append(&buffer, next, find - next);
+        next = find + 1;
+
+        // Skip if escaped.  Escapes are checked against the output so far, so
+        // that a backslash at the end of a substituted value also counts.
+        const char *out = buffer.data;
+        size_t out_length = buffer.length;
+        if (out_length > 0 && out[out_length - 1] == '\\') {
+            if (out_length == 1 || out[out_length - 2] != '\\') {
+                hwd_variables_buffer_append(&buffer, "$", 1);
+                continue;
+            }
+        }
+
+        // Unescape double $ and move on.
+        if (find[1] == '$') {
+            hwd_variables_buffer_append(&buffer, "$", 1);
+            next = find + 2;
+            continue;
+        }
+
+        const struct hwd_variables_slot *slot = hwd_variables_match(variables, find);
+        if (slot == NULL) {
+            hwd_variables_buffer_append(&buffer, "$", 1);
+            continue;
+        }
+
+        hwd_variables_buffer_append(&buffer, slot->value, slot->value_length);
+        next = find + slot->name_length;
+    }
+    hwd_variables_buffer_append(&buffer, next, strlen(next));
+
+    buffer.data[buffer.length] = '\0';
+    return buffer.data;
+}
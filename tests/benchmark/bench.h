@@ -0,0 +1,32 @@
+#ifndef HWD_BENCH_H
+#define HWD_BENCH_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Harness shared by the benchmarks.  Each benchmark is built as a standalone
+// executable from a single file, so the helpers live in this header.
+
+// Minimum time to spend timing each case.
+#define BENCH_MIN_DURATION_NS 100000000ULL
+
+// Starting state for `bench_random`, so that every run sees the same inputs.
+#define BENCH_SEED 0x9e3779b97f4a7c15ULL
+
+static inline uint64_t
+bench_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+static inline uint32_t
+bench_random(uint64_t *state) {
+    // xorshift64.
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return (uint32_t)*state;
+}
+
+#endif
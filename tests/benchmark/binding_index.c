@@ -0,0 +1,234 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hayward/binding_index.h>
+
+#include "bench.h"
+
+// Compares looking up key bindings through the binding index with scanning
+// every binding in the mode, which is what the keyboard code used to do.
+
+#define MAX_KEYS 3
+#define NUM_MODIFIERS 4
+#define NUM_KEYS 64
+#define NUM_QUERIES 4096
+
+struct bench_binding {
+    uint32_t modifiers;
+    bool release;
+    const char *input;
+    uint32_t keys[MAX_KEYS];
+    int keys_length;
+};
+
+struct bench_query {
+    uint32_t modifiers;
+    bool release;
+    uint32_t pressed[MAX_KEYS];
+    int pressed_length;
+    uint32_t current;
+};
+
+static const char *bench_inputs[] = {
+    "*",
+    "1:1:AT_Translated_Set_2_keyboard",
+    "1133:49948:Logitech",
+};
+
+static uint64_t seed = BENCH_SEED;
+
+static int
+bench_key_cmp(const void *a, const void *b) {
+    uint32_t key_a = *(const uint32_t *)a;
+    uint32_t key_b = *(const uint32_t *)b;
+    return key_a < key_b ? -1 : key_a > key_b;
+}
+
+static void
+bench_random_keys(uint32_t *keys, int *keys_length) {
+    *keys_length = 1 + bench_random(&seed) % MAX_KEYS;
+    for (int i = 0; i < *keys_length; i++) {
+        keys[i] = bench_random(&seed) % NUM_KEYS;
+    }
+    qsort(keys, *keys_length, sizeof(uint32_t), bench_key_cmp);
+}
+
+/**
+ * Equivalent of the filtering that used to be done for every binding on every
+ * key press.
+ */
+static bool
+bench_linear_matches(const struct bench_binding *binding, const struct bench_query *query) {
+    if (query->modifiers ^ binding->modifiers || query->release != binding->release) {
+        return false;
+    }
+
+    if (query->pressed_length == binding->keys_length) {
+        for (int i = 0; i < query->pressed_length; i++) {
+            if (binding->keys[i] != query->pressed[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return binding->keys_length == 1 && binding->keys[0] == query->current;
+}
+
+static int
+bench_linear_lookup(
+    const struct bench_binding *bindings, int num_bindings, const struct bench_query *query,
+    int *matches
+) {
+    int count = 0;
+    for (int i = 0; i < num_bindings; i++) {
+        const char *input = bindings[i].input;
+        if (strcmp(input, "*") != 0 && strcmp(input, bench_inputs[1]) != 0) {
+            continue;
+        }
+        if (bench_linear_matches(&bindings[i], query)) {
+            matches[count++] = i;
+        }
+    }
+    return count;
+}
+
+static int
+bench_index_lookup(
+    struct hwd_binding_index *index, int input_id, const struct bench_query *query, int *matches
+) {
+    int count = hwd_binding_index_match(
+        index, query->modifiers, query->release, query->pressed, query->pressed_length,
+        query->current
+    );
+
+    int filtered = 0;
+    for (int i = 0; i < count; i++) {
+        const struct hwd_binding_index_entry *entry = &index->entries[index->matches[i]];
+        if (entry->input != input_id && entry->input != HWD_BINDING_INDEX_INPUT_ANY) {
+            continue;
+        }
+        matches[filtered++] = index->matches[i];
+    }
+    return filtered;
+}
+
+static bool
+bench_run(int num_bindings) {
+    struct bench_binding *bindings = calloc(num_bindings, sizeof(struct bench_binding));
+    assert(bindings != NULL);
+
+    struct hwd_binding_index *index = hwd_binding_index_create();
+    for (int i = 0; i < num_bindings; i++) {
+        struct bench_binding *binding = &bindings[i];
+        binding->modifiers = bench_random(&seed) % (1 << NUM_MODIFIERS);
+        binding->release = bench_random(&seed) % 8 == 0;
+        binding->input = bench_inputs[bench_random(&seed) % 3];
+        bench_random_keys(binding->keys, &binding->keys_length);
+
+        hwd_binding_index_add(
+            index, binding->modifiers, binding->release, binding->keys, binding->keys_length,
+            hwd_binding_index_intern_input(index, binding->input), binding
+        );
+    }
+    int input_id = hwd_binding_index_find_input(index, bench_inputs[1]);
+
+    // Half of the queries are for bindings that exist, so that both hits and
+    // misses are measured.
+    struct bench_query *queries = calloc(NUM_QUERIES, sizeof(struct bench_query));
+    assert(queries != NULL);
+    for (int i = 0; i < NUM_QUERIES; i++) {
+        struct bench_query *query = &queries[i];
+        if (i % 2 == 0) {
+            const struct bench_binding *binding = &bindings[bench_random(&seed) % num_bindings];
+            query->modifiers = binding->modifiers;
+            query->release = binding->release;
+            memcpy(query->pressed, binding->keys, sizeof(query->pressed));
+            query->pressed_length = binding->keys_length;
+            query->current = binding->keys[bench_random(&seed) % binding->keys_length];
+        } else {
+            query->modifiers = bench_random(&seed) % (1 << NUM_MODIFIERS);
+            query->release = bench_random(&seed) % 8 == 0;
+            bench_random_keys(query->pressed, &query->pressed_length);
+            query->current = query->pressed[bench_random(&seed) % query->pressed_length];
+        }
+    }
+
+    int *expected = calloc(num_bindings, sizeof(int));
+    assert(expected != NULL);
+    int *actual = calloc(num_bindings, sizeof(int));
+    assert(actual != NULL);
+
+    bool passed = true;
+    for (int i = 0; i < NUM_QUERIES; i++) {
+        int expected_count = bench_linear_lookup(bindings, num_bindings, &queries[i], expected);
+        int actual_count = bench_index_lookup(index, input_id, &queries[i], actual);
+        if (expected_count != actual_count ||
+            memcmp(expected, actual, sizeof(int) * expected_count) != 0) {
+            fprintf(
+                stderr, "Query %d against %d bindings: expected %d matches, got %d\n", i,
+                num_bindings, expected_count, actual_count
+            );
+            passed = false;
+        }
+    }
+
+    uint64_t lookups = 0;
+    uint64_t begin = bench_now();
+    uint64_t elapsed = 0;
+    while (elapsed < BENCH_MIN_DURATION_NS) {
+        for (int i = 0; i < NUM_QUERIES; i++) {
+            bench_linear_lookup(bindings, num_bindings, &queries[i], expected);
+        }
+        lookups += NUM_QUERIES;
+        elapsed = bench_now() - begin;
+    }
+    double linear_ns = (double)elapsed / lookups;
+
+    lookups = 0;
+    begin = bench_now();
+    elapsed = 0;
+    while (elapsed < BENCH_MIN_DURATION_NS) {
+        for (int i = 0; i < NUM_QUERIES; i++) {
+            bench_index_lookup(index, input_id, &queries[i], actual);
+        }
+        lookups += NUM_QUERIES;
+        elapsed = bench_now() - begin;
+    }
+    double index_ns = (double)elapsed / lookups;
+
+    printf("%9d %12.1f %12.1f\n", num_bindings, linear_ns, index_ns);
+
+    free(actual);
+    free(expected);
+    free(queries);
+    hwd_binding_index_destroy(index);
+    free(bindings);
+
+    return passed;
+}
+
+int
+main(int argc, char **argv) {
+    static const int sizes[] = {10, 100, 1000, 10000};
+
+    bool passed = true;
+
+    printf("%9s %12s %12s\n", "bindings", "linear ns", "index ns");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        passed &= bench_run(sizes[i]);
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,483 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include <assert.h>
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hayward/layout.h>
+
+#include "bench.h"
+
+// Benchmarks the layout calculations on synthetic trees.  The layout code
+// does not allocate, so only the time taken per transaction is reported.
+
+#define OUTPUT_WIDTH 2560
+#define OUTPUT_HEIGHT 1440
+#define COLUMN_GAP 4
+#define TITLEBAR_HEIGHT 24
+#define WINDOWS_PER_COLUMN 8
+#define BORDER_WIDTH 2
+
+#define MIN_TRANSACTIONS 100
+
+struct bench_column {
+    int output;
+
+    struct hwd_layout_column params;
+    struct hwd_layout_column_child *children;
+    int length;
+
+    int active;
+
+    // Index of the first child whose inputs have been changed since the last
+    // layout.  Equal to `length` if the column is clean.
+    int first_changed;
+};
+
+struct bench_floating_window {
+    int output;
+
+    double center_x, center_y;
+    double requested_width, requested_height;
+    struct hwd_layout_size_limits limits;
+
+    bool dirty;
+
+    // Outputs.
+    struct hwd_layout_box box;
+    struct hwd_layout_box content;
+};
+
+struct bench_tree {
+    int num_outputs;
+    struct hwd_layout_box *outputs;
+
+    int num_columns;
+    struct bench_column *columns;
+
+    int num_floating;
+    struct bench_floating_window *floating;
+
+    // Scratch space for laying out the columns on a single output.
+    struct hwd_layout_tiling_column *tiling;
+    double *width_fractions;
+
+    uint64_t seed;
+};
+
+enum bench_scenario {
+    BENCH_FULL,
+    BENCH_RESIZE,
+    BENCH_FOCUS,
+    BENCH_PREVIEW,
+    BENCH_FLOATING,
+};
+
+static const char *bench_scenario_names[] = {
+    [BENCH_FULL] = "full",
+    [BENCH_RESIZE] = "resize",
+    [BENCH_FOCUS] = "focus",
+    [BENCH_PREVIEW] = "preview",
+    [BENCH_FLOATING] = "floating",
+};
+
+static const struct hwd_layout_borders bench_borders = {
+    .titlebar_height = TITLEBAR_HEIGHT,
+    .left = BORDER_WIDTH,
+    .right = BORDER_WIDTH,
+    .top = BORDER_WIDTH,
+    .bottom = BORDER_WIDTH,
+};
+
+// Let the floating size limits be picked automatically, which makes them
+// depend on the size of the output layout.
+static const struct hwd_layout_size_limits bench_floating_config = {0};
+
+/**
+ * Creates a tree with `num_windows` windows spread over `num_outputs` outputs.
+ * The windows are tiled, unless `floating` is set in which case they are all
+ * floating and the columns are left empty.
+ */
+static struct bench_tree *
+bench_tree_create(int num_outputs, int num_windows, bool floating) {
+    struct bench_tree *tree = calloc(1, sizeof(struct bench_tree));
+    assert(tree != NULL);
+
+    tree->seed = BENCH_SEED;
+
+    tree->num_outputs = num_outputs;
+    tree->outputs = calloc(num_outputs, sizeof(struct hwd_layout_box));
+    assert(tree->outputs != NULL);
+    for (int i = 0; i < num_outputs; i++) {
+        tree->outputs[i].x = i * OUTPUT_WIDTH;
+        tree->outputs[i].y = 0;
+        tree->outputs[i].width = OUTPUT_WIDTH;
+        tree->outputs[i].height = OUTPUT_HEIGHT;
+    }
+
+    int num_tiled = floating ? 0 : num_windows;
+
+    tree->num_columns = (num_tiled + WINDOWS_PER_COLUMN - 1) / WINDOWS_PER_COLUMN;
+    if (tree->num_columns < num_outputs) {
+        tree->num_columns = num_outputs;
+    }
+    tree->columns = calloc(tree->num_columns, sizeof(struct bench_column));
+    assert(tree->columns != NULL);
+
+    tree->tiling = calloc(tree->num_columns, sizeof(struct hwd_layout_tiling_column));
+    assert(tree->tiling != NULL);
+    tree->width_fractions = calloc(tree->num_columns, sizeof(double));
+    assert(tree->width_fractions != NULL);
+
+    int remaining = num_tiled;
+    for (int i = 0; i < tree->num_columns; i++) {
+        struct bench_column *column = &tree->columns[i];
+
+        int length = remaining / (tree->num_columns - i);
+        remaining -= length;
+
+        column->output = i % num_outputs;
+        column->params.stacked = i % 2 == 1;
+        column->params.preview_titlebar_height = TITLEBAR_HEIGHT;
+        column->params.preview_height_fraction = 1.0;
+        column->params.preview_baseline = 0.5;
+
+        column->length = length;
+        column->children = calloc(length > 0 ? length : 1, sizeof(*column->children));
+        assert(column->children != NULL);
+        for (int j = 0; j < length; j++) {
+            column->children[j].height_fraction = 1.0;
+            column->children[j].titlebar_height = TITLEBAR_HEIGHT;
+        }
+        if (length > 0) {
+            column->children[0].active = true;
+        }
+    }
+
+    tree->num_floating = floating ? num_windows : 0;
+    tree->floating =
+        calloc(tree->num_floating > 0 ? tree->num_floating : 1, sizeof(*tree->floating));
+    assert(tree->floating != NULL);
+    for (int i = 0; i < tree->num_floating; i++) {
+        struct bench_floating_window *window = &tree->floating[i];
+
+        window->output = i % num_outputs;
+        window->center_x = (bench_random(&tree->seed) % 100) / 100.0;
+        window->center_y = (bench_random(&tree->seed) % 100) / 100.0;
+        window->requested_width = 100 + bench_random(&tree->seed) % OUTPUT_WIDTH;
+        window->requested_height = 100 + bench_random(&tree->seed) % OUTPUT_HEIGHT;
+
+        // Roughly half of the windows ask for size limits of their own.
+        if (bench_random(&tree->seed) % 2 == 0) {
+            window->limits.min_width = 100 + bench_random(&tree->seed) % 200;
+            window->limits.min_height = 100 + bench_random(&tree->seed) % 200;
+            window->limits.max_width = 400 + bench_random(&tree->seed) % 800;
+            window->limits.max_height = 400 + bench_random(&tree->seed) % 800;
+        }
+    }
+
+    return tree;
+}
+
+static void
+bench_tree_destroy(struct bench_tree *tree) {
+    for (int i = 0; i < tree->num_columns; i++) {
+        free(tree->columns[i].children);
+    }
+    free(tree->columns);
+    free(tree->floating);
+    free(tree->tiling);
+    free(tree->width_fractions);
+    free(tree->outputs);
+    free(tree);
+}
+
+static void
+bench_tree_invalidate(struct bench_tree *tree) {
+    for (int i = 0; i < tree->num_columns; i++) {
+        struct bench_column *column = &tree->columns[i];
+        column->first_changed = 0;
+        column->params.box.width = -1;
+    }
+    for (int i = 0; i < tree->num_floating; i++) {
+        tree->floating[i].dirty = true;
+    }
+}
+
+/**
+ * Returns the box containing every output, which the automatic floating size
+ * limits are derived from.
+ */
+static struct hwd_layout_box
+bench_tree_layout_box(struct bench_tree *tree) {
+    struct hwd_layout_box box = tree->outputs[0];
+    for (int i = 1; i < tree->num_outputs; i++) {
+        struct hwd_layout_box *output = &tree->outputs[i];
+        double right = fmax(box.x + box.width, output->x + output->width);
+        double bottom = fmax(box.y + box.height, output->y + output->height);
+        box.x = fmin(box.x, output->x);
+        box.y = fmin(box.y, output->y);
+        box.width = right - box.x;
+        box.height = bottom - box.y;
+    }
+    return box;
+}
+
+/**
+ * Clamps the size requested for a floating window to the size limits, and then
+ * positions it on its output, in the same way as resizing a floating window
+ * followed by `window_arrange`.
+ */
+static void
+bench_floating_window_arrange(
+    struct bench_tree *tree, struct bench_floating_window *window,
+    const struct hwd_layout_box *layout_box
+) {
+    struct hwd_layout_size_limits constraints;
+    hwd_layout_floating_constraints(
+        &bench_floating_config, &window->limits, layout_box->width, layout_box->height,
+        &constraints
+    );
+
+    double width =
+        fmax(constraints.min_width, fmin(window->requested_width, constraints.max_width));
+    double height =
+        fmax(constraints.min_height, fmin(window->requested_height, constraints.max_height));
+
+    hwd_layout_window_floating(
+        &tree->outputs[window->output], window->center_x, window->center_y, width, height,
+        &bench_borders, &window->box
+    );
+    hwd_layout_window_content(&window->box, &bench_borders, &window->content);
+}
+
+/**
+ * Equivalent of a single transaction's worth of arranging.  Columns are laid
+ * out incrementally, in the same way as `column_arrange`.
+ */
+static void
+bench_tree_arrange(struct bench_tree *tree) {
+    for (int i = 0; i < tree->num_outputs; i++) {
+        int count = 0;
+        for (int j = 0; j < tree->num_columns; j++) {
+            struct bench_column *column = &tree->columns[j];
+            if (column->output != i) {
+                continue;
+            }
+            tree->tiling[count].width_fraction = tree->width_fractions[j];
+            count++;
+        }
+
+        hwd_layout_tiling(&tree->outputs[i], COLUMN_GAP, tree->tiling, count);
+
+        count = 0;
+        for (int j = 0; j < tree->num_columns; j++) {
+            struct bench_column *column = &tree->columns[j];
+            if (column->output != i) {
+                continue;
+            }
+            tree->width_fractions[j] = tree->tiling[count].width_fraction;
+
+            struct hwd_layout_column next = column->params;
+            next.box = tree->tiling[count].box;
+            count++;
+
+            hwd_layout_column_prepare(&next, column->children, column->length);
+
+            int first = hwd_layout_column_resume_index(
+                &column->params, column->length, &next, column->length, column->first_changed
+            );
+            column->first_changed = column->length;
+            if (first == column->length) {
+                continue;
+            }
+
+            hwd_layout_column(&next, column->children, column->length, first);
+            column->params = next;
+        }
+    }
+
+    struct hwd_layout_box layout_box = bench_tree_layout_box(tree);
+    for (int i = 0; i < tree->num_floating; i++) {
+        struct bench_floating_window *window = &tree->floating[i];
+        if (!window->dirty) {
+            continue;
+        }
+        bench_floating_window_arrange(tree, window, &layout_box);
+        window->dirty = false;
+    }
+}
+
+static void
+bench_tree_mutate(struct bench_tree *tree, enum bench_scenario scenario) {
+    if (scenario == BENCH_FLOATING) {
+        // Change the mode of one output.  This moves every floating window on
+        // the output, and changes the automatic size limits of all of them.
+        int output = bench_random(&tree->seed) % tree->num_outputs;
+        tree->outputs[output].width = OUTPUT_WIDTH - (bench_random(&tree->seed) % 4) * 320;
+        tree->outputs[output].height = OUTPUT_HEIGHT - (bench_random(&tree->seed) % 4) * 180;
+        for (int i = 0; i < tree->num_floating; i++) {
+            tree->floating[i].dirty = true;
+        }
+        return;
+    }
+
+    struct bench_column *column = &tree->columns[bench_random(&tree->seed) % tree->num_columns];
+    if (column->length == 0) {
+        return;
+    }
+
+    switch (scenario) {
+    case BENCH_FULL:
+        bench_tree_invalidate(tree);
+        break;
+
+    case BENCH_RESIZE: {
+        int index = bench_random(&tree->seed) % column->length;
+        column->children[index].height_fraction = 0.5 + (bench_random(&tree->seed) % 100) / 100.0;
+        if (index < column->first_changed) {
+            column->first_changed = index;
+        }
+        break;
+    }
+
+    case BENCH_FOCUS: {
+        int prev = column->active;
+        int next = bench_random(&tree->seed) % column->length;
+        column->children[prev].active = false;
+        column->children[next].active = true;
+        column->active = next;
+        int index = prev < next ? prev : next;
+        if (index < column->first_changed) {
+            column->first_changed = index;
+        }
+        break;
+    }
+
+    case BENCH_PREVIEW:
+        column->params.show_preview = true;
+        column->params.preview_anchor_y = bench_random(&tree->seed) % OUTPUT_HEIGHT;
+        column->first_changed = 0;
+        break;
+
+    case BENCH_FLOATING:
+        break;
+    }
+}
+
+/**
+ * Checks that incremental layout gave the same result as laying out every
+ * column from scratch.
+ */
+static bool
+bench_tree_check(struct bench_tree *tree) {
+    bool passed = true;
+
+    for (int i = 0; i < tree->num_columns; i++) {
+        struct bench_column *column = &tree->columns[i];
+
+        struct hwd_layout_column_child *expected =
+            calloc(column->length > 0 ? column->length : 1, sizeof(*expected));
+        assert(expected != NULL);
+        memcpy(expected, column->children, sizeof(*expected) * column->length);
+
+        struct hwd_layout_column params = column->params;
+        hwd_layout_column_prepare(&params, expected, column->length);
+        hwd_layout_column(&params, expected, column->length, 0);
+
+        for (int j = 0; j < column->length; j++) {
+            if (expected[j].y != column->children[j].y ||
+                expected[j].height != column->children[j].height ||
+                expected[j].shaded != column->children[j].shaded) {
+                fprintf(
+                    stderr, "Column %d child %d: expected y=%g height=%g, got y=%g height=%g\n",
+                    i, j, expected[j].y, expected[j].height, column->children[j].y,
+                    column->children[j].height
+                );
+                passed = false;
+            }
+        }
+
+        free(expected);
+    }
+
+    struct hwd_layout_box layout_box = bench_tree_layout_box(tree);
+    for (int i = 0; i < tree->num_floating; i++) {
+        struct bench_floating_window expected = tree->floating[i];
+        bench_floating_window_arrange(tree, &expected, &layout_box);
+
+        struct hwd_layout_box *box = &tree->floating[i].box;
+        if (expected.box.x != box->x || expected.box.y != box->y ||
+            expected.box.width != box->width || expected.box.height != box->height) {
+            fprintf(
+                stderr, "Floating window %d: expected %gx%g at %g,%g, got %gx%g at %g,%g\n", i,
+                expected.box.width, expected.box.height, expected.box.x, expected.box.y,
+                box->width, box->height, box->x, box->y
+            );
+            passed = false;
+        }
+    }
+
+    return passed;
+}
+
+static bool
+bench_run(int num_outputs, int num_windows, enum bench_scenario scenario) {
+    struct bench_tree *tree =
+        bench_tree_create(num_outputs, num_windows, scenario == BENCH_FLOATING);
+
+    bench_tree_invalidate(tree);
+    bench_tree_arrange(tree);
+
+    uint64_t transactions = 0;
+    uint64_t elapsed = 0;
+
+    while (elapsed < BENCH_MIN_DURATION_NS || transactions < MIN_TRANSACTIONS) {
+        bench_tree_mutate(tree, scenario);
+
+        uint64_t begin = bench_now();
+        bench_tree_arrange(tree);
+        elapsed += bench_now() - begin;
+
+        transactions++;
+    }
+
+    printf(
+        "%7d %7d %-8s %12.0f\n", num_outputs, num_windows, bench_scenario_names[scenario],
+        (double)elapsed / transactions
+    );
+
+    bool passed = bench_tree_check(tree);
+
+    bench_tree_destroy(tree);
+
+    return passed;
+}
+
+int
+main(int argc, char **argv) {
+    static const int outputs[] = {1, 4, 16};
+    static const int windows[] = {10, 100, 1000};
+
+    bool passed = true;
+
+    printf("%7s %7s %-8s %12s\n", "outputs", "windows", "scenario", "ns/txn");
+
+    for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); i++) {
+        for (size_t j = 0; j < sizeof(windows) / sizeof(windows[0]); j++) {
+            for (int scenario = BENCH_FULL; scenario <= BENCH_FLOATING; scenario++) {
+                passed &= bench_run(outputs[i], windows[j], scenario);
+            }
+        }
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
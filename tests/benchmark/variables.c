@@ -0,0 +1,229 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <hayward/variables.h>
+
+#include "bench.h"
+
+// Compares expanding variables through the hash table with scanning a list of
+// variables sorted from longest to shortest name at every `$`, which is what
+// the config code used to do.
+
+#define NUM_LINES 1024
+#define WORDS_PER_LINE 8
+
+struct bench_variable {
+    char *name;
+    char *value;
+};
+
+static uint64_t seed = BENCH_SEED;
+
+static int
+bench_variable_cmp(const void *a, const void *b) {
+    const struct bench_variable *var_a = a;
+    const struct bench_variable *var_b = b;
+    return (int)strlen(var_b->name) - (int)strlen(var_a->name);
+}
+
+/**
+ * Equivalent of the old `do_var_replacement`.
+ */
+static char *
+bench_linear_expand(const struct bench_variable *variables, int num_variables, char *str) {
+    int i;
+    char *find = str;
+    while ((find = strchr(find, '$'))) {
+        if (find > str && find[-1] == '\\') {
+            if (find == str + 1 || !(find > str + 1 && find[-2] == '\\')) {
+                ++find;
+                continue;
+            }
+        }
+        if (find[1] == '$') {
+            size_t length = strlen(find + 1);
+            memmove(find, find + 1, length);
+            find[length] = '\0';
+            ++find;
+            continue;
+        }
+        for (i = 0; i < num_variables; ++i) {
+            const struct bench_variable *var = &variables[i];
+            int vnlen = strlen(var->name);
+            if (strncmp(find, var->name, vnlen) == 0) {
+                int vvlen = strlen(var->value);
+                char *newstr = malloc(strlen(str) - vnlen + vvlen + 1);
+                assert(newstr != NULL);
+                char *newptr = newstr;
+                int offset = find - str;
+                strncpy(newptr, str, offset);
+                newptr += offset;
+                strncpy(newptr, var->value, vvlen);
+                newptr += vvlen;
+                strcpy(newptr, find + vnlen);
+                free(str);
+                str = newstr;
+                find = str + offset + vvlen;
+                break;
+            }
+        }
+        if (i == num_variables) {
+            ++find;
+        }
+    }
+    return str;
+}
+
+static char *
+bench_format(const char *format, int n) {
+    int length = snprintf(NULL, 0, format, n);
+    char *str = malloc(length + 1);
+    assert(str != NULL);
+    snprintf(str, length + 1, format, n);
+    return str;
+}
+
+/**
+ * Generates a line of words, some of which refer to variables, some of which
+ * are escaped and some of which refer to names that are not defined.
+ */
+static char *
+bench_random_line(int num_variables) {
+    char line[1024] = "";
+    for (int i = 0; i < WORDS_PER_LINE; i++) {
+        char word[64];
+        int n = bench_random(&seed) % num_variables;
+        switch (bench_random(&seed) % 8) {
+        case 0:
+            snprintf(word, sizeof(word), "\\$var%d", n);
+            break;
+        case 1:
+            snprintf(word, sizeof(word), "\\\\$var%d", n);
+            break;
+        case 2:
+            snprintf(word, sizeof(word), "$$var%d", n);
+            break;
+        case 3:
+            snprintf(word, sizeof(word), "$undefined%d", n);
+            break;
+        case 4:
+            snprintf(word, sizeof(word), "$var%dsuffix", n);
+            break;
+        default:
+            snprintf(word, sizeof(word), "$var%d", n);
+            break;
+        }
+        if (i > 0) {
+            strcat(line, " ");
+        }
+        strcat(line, word);
+    }
+    char *copy = strdup(line);
+    assert(copy != NULL);
+    return copy;
+}
+
+static bool
+bench_run(int num_variables) {
+    struct bench_variable *variables = calloc(num_variables, sizeof(struct bench_variable));
+    assert(variables != NULL);
+
+    struct hwd_variables *table = hwd_variables_create();
+    for (int i = 0; i < num_variables; i++) {
+        variables[i].name = bench_format("$var%d", i);
+        // Some values end in a backslash, to check that it escapes the `$`
+        // that follows.
+        variables[i].value =
+            bench_format(bench_random(&seed) % 4 == 0 ? "value%d\\" : "value%d", i);
+        hwd_variables_set(table, variables[i].name, variables[i].value);
+    }
+    qsort(variables, num_variables, sizeof(struct bench_variable), bench_variable_cmp);
+
+    char **lines = calloc(NUM_LINES, sizeof(char *));
+    assert(lines != NULL);
+    for (int i = 0; i < NUM_LINES; i++) {
+        lines[i] = bench_random_line(num_variables);
+    }
+
+    bool passed = true;
+    for (int i = 0; i < NUM_LINES; i++) {
+        char *copy = strdup(lines[i]);
+        assert(copy != NULL);
+        char *expected = bench_linear_expand(variables, num_variables, copy);
+        char *actual = hwd_variables_expand(table, lines[i]);
+        if (strcmp(expected, actual) != 0) {
+            fprintf(
+                stderr, "Line '%s': expected '%s', got '%s'\n", lines[i], expected, actual
+            );
+            passed = false;
+        }
+        free(expected);
+        free(actual);
+    }
+
+    uint64_t expansions = 0;
+    uint64_t begin = bench_now();
+    uint64_t elapsed = 0;
+    while (elapsed < BENCH_MIN_DURATION_NS) {
+        for (int i = 0; i < NUM_LINES; i++) {
+            char *copy = strdup(lines[i]);
+            assert(copy != NULL);
+            free(bench_linear_expand(variables, num_variables, copy));
+        }
+        expansions += NUM_LINES;
+        elapsed = bench_now() - begin;
+    }
+    double linear_ns = (double)elapsed / expansions;
+
+    expansions = 0;
+    begin = bench_now();
+    elapsed = 0;
+    while (elapsed < BENCH_MIN_DURATION_NS) {
+        for (int i = 0; i < NUM_LINES; i++) {
+            free(hwd_variables_expand(table, lines[i]));
+        }
+        expansions += NUM_LINES;
+        elapsed = bench_now() - begin;
+    }
+    double table_ns = (double)elapsed / expansions;
+
+    printf("%9d %12.1f %12.1f\n", num_variables, linear_ns, table_ns);
+
+    for (int i = 0; i < NUM_LINES; i++) {
+        free(lines[i]);
+    }
+    free(lines);
+    hwd_variables_destroy(table);
+    for (int i = 0; i < num_variables; i++) {
+        free(variables[i].name);
+        free(variables[i].value);
+    }
+    free(variables);
+
+    return passed;
+}
+
+int
+main(int argc, char **argv) {
+    static const int sizes[] = {10, 100, 1000, 10000};
+
+    bool passed = true;
+
+    printf("%9s %12s %12s\n", "variables", "linear ns", "table ns");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        passed &= bench_run(sizes[i]);
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
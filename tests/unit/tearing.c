@@ -0,0 +1,77 @@
+#define _XOPEN_SOURCE 700
+#define _POSIX_C_SOURCE 200809L
+
+#include <config.h>
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <hayward/tearing.h>
+
+// Checks the tearing policy in `src/tearing.c` without a compositor.
+
+struct test_case {
+    const char *name;
+    struct hwd_tearing_state state;
+    bool expected;
+};
+
+static const struct test_case test_cases[] = {
+    {
+        .name = "both agree",
+        .state = {.has_fullscreen_window = true,
+                  .window_allows_tearing = true,
+                  .window_requests_async = true},
+        .expected = true,
+    },
+    {
+        .name = "locked",
+        .state = {.has_fullscreen_window = true,
+                  .window_allows_tearing = true,
+                  .window_requests_async = true,
+                  .locked = true},
+        .expected = false,
+    },
+    {
+        .name = "no fullscreen window",
+        .state = {.window_allows_tearing = true, .window_requests_async = true},
+        .expected = false,
+    },
+    {
+        .name = "user only",
+        .state = {.has_fullscreen_window = true, .window_allows_tearing = true},
+        .expected = false,
+    },
+    {
+        .name = "client only",
+        .state = {.has_fullscreen_window = true, .window_requests_async = true},
+        .expected = false,
+    },
+    {
+        .name = "neither",
+        .state = {.has_fullscreen_window = true},
+        .expected = false,
+    },
+};
+
+int
+main(int argc, char **argv) {
+    bool passed = true;
+
+    for (size_t i = 0; i < sizeof(test_cases) / sizeof(test_cases[0]); i++) {
+        const struct test_case *test_case = &test_cases[i];
+
+        bool result = hwd_tearing_should_tear(&test_case->state);
+        if (result != test_case->expected) {
+            fprintf(
+                stderr, "%s: expected %s, got %s\n", test_case->name,
+                test_case->expected ? "tearing" : "no tearing", result ? "tearing" : "no tearing"
+            );
+            passed = false;
+        }
+    }
+
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}